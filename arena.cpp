@@ -0,0 +1,392 @@
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <signal.h>
+#include "gobang.h"
+#include "grid.hpp"
+#include "winJudge.h"
+#include "exec.h"
+#include "arenaStats.hpp"
+
+/*
+    Self-play arena: engine-vs-engine matches between two gobang builds or configurations.
+
+    Usage: arena [engine A] [engine B] (both default to ./gobang)
+
+    Every concurrent game slot keeps one persistent engine of each side (KEEP_RUNNING) fed with
+    incremental requests over exec.c pipes. Games come in pairs that share a random opening and
+    swap colours. Each game line on stdout gives the result for the pair's engines and their thinking
+    time; progress and the final Elo estimate, SPRT state and per-engine move latencies go to stderr.
+    An engine that fails to answer in time, answers garbage or plays an occupied cell loses the game
+    and is replaced. Replacements come from a pool of spare, warmed-up engines per side that the main
+    thread refills, so no game waits for a spawn; engines that exit between games are replaced too.
+
+    Configuration:
+        ARENA_GAMES: games to play, rounded up to whole pairs (default 100)
+        ARENA_CONCURRENCY: games played at once, each with its own pair of engines (default half the hardware threads)
+        ARENA_OPENING_PLIES: random opening moves near the centre (default 4)
+        ARENA_SEED: opening seed (default 1)
+        ARENA_TIME_MS / ARENA_NODES / ARENA_DEPTH: per-move limits for both engines, passed on as
+            SEARCH_TIME_MS / SEARCH_NODES / SEARCH_DEPTH; 100ms per move when none is given
+        ARENA_MOVE_TIMEOUT: seconds before a move counts as lost on time (default 30)
+        ARENA_SPARE_ENGINES: spare engines kept ready per side (default 2)
+        ARENA_ENV_A / ARENA_ENV_B: extra environment for one engine, "NAME=value NAME=value",
+            applied after the limits, e.g. ARENA_ENV_B="PONDER=1" or a time odds match
+        ARENA_ELO0 / ARENA_ELO1 / ARENA_ALPHA / ARENA_BETA: SPRT hypotheses and error rates
+            (default 0, 10, 0.05, 0.05); the match stops at the next pair once the test decides,
+            or runs all games with ARENA_NO_SPRT_STOP
+*/
+
+struct ArenaEngine {
+    const char * name;
+    const char * path;
+    std::vector<std::pair<std::string, std::string>> environment;
+};
+
+struct ArenaConfig {
+    int pairs = 50;
+    int concurrency = std::max(1u, std::thread::hardware_concurrency() / 2);
+    int openingPlies = 4;
+    unsigned long long seed = 1;
+    unsigned int moveTimeout = 30;
+    int spareEngines = 2;
+    double elo0 = 0, elo1 = 10, alpha = 0.05, beta = 0.05;
+    bool sprtStop = true;
+    std::vector<std::pair<std::string, std::string>> limits; // Shared by both engines
+} config;
+ArenaEngine engines[2] = { { "A", "./gobang", {} }, { "B", "./gobang", {} } };
+
+// One engine of a game slot; its board follows the game once synced
+struct Seat {
+    int engine; // Index into engines
+    EngineProcess process = { -1, -1, -1, -1 };
+    bool running = false;
+    bool synced = false;
+};
+
+struct GameRecord {
+    int game, pair, black; // black is the engine index that moved first
+    double result; // For engine A
+    const char * reason; // five, full or forfeit
+    int moves;
+    double milliseconds[2]; // Thinking time per engine
+};
+
+// Spares are checked for being alive before they are handed out, and answer this before joining the pool
+constexpr const char * WARMUP_REQUEST = "{\"type\":1}\n";
+std::mutex spawnMutex; // The environment is process-wide: spawn one engine at a time, also guards the pools
+std::condition_variable poolDrawn; // A seat took an engine, the main thread refills
+EnginePool pools[2];
+bool poolBroken[2]; // Refilling failed, seats spawn on their own from then on
+int activeSlots;
+std::mutex resultsMutex;
+MatchScore matchScore;
+std::vector<double> latencies[2]; // Milliseconds per move, per engine
+std::atomic<int> nextPair(0);
+std::atomic<bool> stopping(false);
+int forfeits[2];
+
+std::vector<std::pair<std::string, std::string>> parseEnvironment(const char * text) {
+    std::vector<std::pair<std::string, std::string>> result;
+    if (!text) return result;
+    std::string all = text;
+    size_t start = 0;
+    while (start < all.size()) {
+        size_t end = all.find(' ', start);
+        if (end == std::string::npos) end = all.size();
+        std::string item = all.substr(start, end - start);
+        size_t equals = item.find('=');
+        if (equals != std::string::npos) result.emplace_back(item.substr(0, equals), item.substr(equals + 1));
+        start = end + 1;
+    }
+    return result;
+}
+
+// Set the environment engine i is spawned with, and remove it again; call with spawnMutex held
+void applyEnvironment(int engine) {
+    setenv("KEEP_RUNNING", "1", 1);
+    unsetenv("BINARY_PROTOCOL");
+    for (const char * name : { "TIMEOUT", "SEARCH_TIME_MS", "SEARCH_NODES", "SEARCH_DEPTH" }) unsetenv(name);
+    for (auto & variable : config.limits) setenv(variable.first.c_str(), variable.second.c_str(), 1);
+    for (auto & variable : engines[engine].environment) setenv(variable.first.c_str(), variable.second.c_str(), 1);
+}
+void restoreEnvironment(int engine) {
+    for (auto & variable : engines[engine].environment) unsetenv(variable.first.c_str());
+}
+
+bool startSeat(Seat & seat) {
+    std::lock_guard<std::mutex> lock(spawnMutex);
+    applyEnvironment(seat.engine);
+    // Spawns directly when the pool is empty
+    seat.running = acquireEngineFromPool(&pools[seat.engine], &seat.process);
+    restoreEnvironment(seat.engine);
+    seat.synced = false;
+    poolDrawn.notify_one();
+    return seat.running;
+}
+void stopSeat(Seat & seat) {
+    if (!seat.running) return;
+    closeEngineProcess(&seat.process, 1);
+    seat.running = false;
+}
+
+// Ask a seat for its move on board, where its own stones are own; false when it fails to give a legal one
+bool askSeat(Seat & seat, const ChessboardGrid & board, ChessPiece own, const std::vector<ChessPosition> & moves,
+    ChessPosition & reply, double & milliseconds) {
+    std::string request;
+    if (!seat.synced) {
+        std::string snapshot(SIZE * SIZE, '0');
+        for (int i = 0; i < SIZE * SIZE; i++) {
+            ChessPiece piece = board.get(i / SIZE, i % SIZE);
+            if (piece != EMPTY) snapshot[i] = piece == own ? '0' + BOT : '0' + PLAYER;
+        }
+        request = "{\"setup\":{\"board\":\"" + snapshot + "\"},\"type\":0}\n";
+    } else {
+        const ChessPosition & last = moves.back();
+        request = "{\"move\":{\"x\":" + std::to_string(last.x) + ",\"y\":" + std::to_string(last.y) + "},\"type\":0}\n";
+    }
+    char * responseBuf;
+    unsigned long responseSize;
+    auto start = std::chrono::steady_clock::now();
+    int retValue = exchangeLineWithProcess(seat.process.stdinFd, seat.process.stdoutFd, request.data(), request.size(),
+        &responseBuf, &responseSize, config.moveTimeout, 0);
+    milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (!retValue) return false;
+    int x, y;
+    bool parsed = sscanf(responseBuf, "{\"response\":{\"x\":%d,\"y\":%d}}", &x, &y) == 2;
+    free(responseBuf);
+    if (!parsed || x < 0 || y < 0 || x >= SIZE || y >= SIZE || board.get(x, y) != EMPTY) return false;
+    reply = ChessPosition(x, y);
+    seat.synced = true; // The engine placed its reply itself
+    return true;
+}
+
+// Random distinct cells within 3 of the centre, the same for both games of a pair
+std::vector<ChessPosition> makeOpening(int pair) {
+    std::mt19937_64 generator(config.seed * 0x9E3779B97F4A7C15ull + pair);
+    std::vector<ChessPosition> opening;
+    ChessboardGrid used;
+    while ((int) opening.size() < config.openingPlies) {
+        int x = SIZE / 2 - 3 + generator() % 7, y = SIZE / 2 - 3 + generator() % 7;
+        if (used.get(x, y) != EMPTY) continue;
+        used.set(x, y, BOT);
+        opening.emplace_back(x, y);
+    }
+    return opening;
+}
+
+// Engine i plays stones of ChessPiece BOT + i on the arena's own board
+GameRecord playGame(Seat seats[2], int game, int pair, int black, const std::vector<ChessPosition> & opening) {
+    GameRecord record = { game, pair, black, 0.5, "full", 0, { 0, 0 } };
+    ChessboardGrid board;
+    std::vector<ChessPosition> moves;
+    std::vector<double> gameLatencies[2];
+    int toMove = black;
+    for (const ChessPosition & move : opening) {
+        board.set(move.x, move.y, (ChessPiece) (BOT + toMove));
+        moves.push_back(move);
+        toMove ^= 1;
+    }
+    seats[0].synced = seats[1].synced = false;
+    while (moves.size() < SIZE * SIZE) {
+        ChessPosition reply;
+        double milliseconds;
+        bool answered = askSeat(seats[toMove], board, (ChessPiece) (BOT + toMove), moves, reply, milliseconds);
+        record.milliseconds[toMove] += milliseconds;
+        if (!answered) {
+            record.result = toMove == 0 ? 0 : 1;
+            record.reason = "forfeit";
+            {
+                std::lock_guard<std::mutex> lock(resultsMutex);
+                forfeits[toMove]++;
+            }
+            // Out of step or dead: replace it for the next game
+            stopSeat(seats[toMove]);
+            startSeat(seats[toMove]);
+            break;
+        }
+        gameLatencies[toMove].push_back(milliseconds);
+        board.set(reply.x, reply.y, (ChessPiece) (BOT + toMove));
+        moves.push_back(reply);
+        if (judgeWinsAt(board, reply.x, reply.y) != EMPTY) {
+            record.result = toMove == 0 ? 1 : 0;
+            record.reason = "five";
+            break;
+        }
+        toMove ^= 1;
+    }
+    record.moves = moves.size();
+    std::lock_guard<std::mutex> lock(resultsMutex);
+    for (int i = 0; i < 2; i++) latencies[i].insert(latencies[i].end(), gameLatencies[i].begin(), gameLatencies[i].end());
+    return record;
+}
+
+void report(const GameRecord & record) {
+    std::lock_guard<std::mutex> lock(resultsMutex);
+    matchScore.add(record.result);
+    const char * winner = record.result > 0.75 ? "A" : record.result < 0.25 ? "B" : "draw";
+    printf("{\"game\":%d,\"pair\":%d,\"black\":\"%s\",\"result\":\"%s\",\"reason\":\"%s\",\"moves\":%d,\"msA\":%.3f,\"msB\":%.3f}\n",
+        record.game, record.pair, engines[record.black].name, winner, record.reason, record.moves,
+        record.milliseconds[0], record.milliseconds[1]);
+    fflush(stdout);
+    double lower, upper, llr;
+    double elo = matchScore.elo(lower, upper);
+    SprtState state = matchScore.sprt(config.elo0, config.elo1, config.alpha, config.beta, &llr);
+    fprintf(stderr, "games %llu: +%llu =%llu -%llu, elo %.1f [%.1f, %.1f], llr %.2f\n", matchScore.games(),
+        matchScore.wins, matchScore.draws, matchScore.losses, elo, lower, upper, llr);
+    // Only whole pairs are scheduled after this, the games in flight still finish
+    if (config.sprtStop && state != SprtState::CONTINUE) stopping = true;
+}
+
+// Replace the engines that exited since their last reply
+void replaceExitedSeats(Seat seats[2]) {
+    EngineProcess processes[2] = { seats[0].process, seats[1].process };
+    int exited;
+    while ((exited = waitAnyEngineProcess(processes, 2, 0)) != -1) {
+        fprintf(stderr, "engine %s exited between games, replacing it\n", engines[seats[exited].engine].name);
+        stopSeat(seats[exited]);
+        startSeat(seats[exited]);
+        processes[exited] = seats[exited].process;
+        if (!seats[exited].running) processes[exited].pid = -1;
+    }
+}
+
+void slot() {
+    Seat seats[2];
+    seats[0].engine = 0;
+    seats[1].engine = 1;
+    if (startSeat(seats[0]) && startSeat(seats[1])) {
+        while (!stopping) {
+            int pair = nextPair++;
+            if (pair >= config.pairs) break;
+            std::vector<ChessPosition> opening = makeOpening(pair);
+            for (int black = 0; black < 2; black++) {
+                replaceExitedSeats(seats);
+                if (!seats[0].running || !seats[1].running) {
+                    fprintf(stderr, "pair %d: engine restart failed\n", pair);
+                    stopping = true;
+                    break;
+                }
+                report(playGame(seats, pair * 2 + black, pair, black, opening));
+            }
+        }
+    } else fprintf(stderr, "failed to start the engines\n");
+    stopSeat(seats[0]);
+    stopSeat(seats[1]);
+    std::lock_guard<std::mutex> lock(spawnMutex);
+    activeSlots--;
+    poolDrawn.notify_one();
+}
+
+// Main thread: fill both pools, then top them up whenever a seat takes an engine, until every slot is done
+void refillPools() {
+    std::unique_lock<std::mutex> lock(spawnMutex);
+    while (activeSlots) {
+        for (int i = 0; i < 2; i++) {
+            if (poolBroken[i] || pools[i].readyCount == pools[i].capacity) continue;
+            applyEnvironment(i);
+            if (!refillEnginePool(&pools[i])) {
+                fprintf(stderr, "engine %s (%s) failed to start a spare\n", engines[i].name, engines[i].path);
+                poolBroken[i] = true;
+            }
+            restoreEnvironment(i);
+        }
+        poolDrawn.wait(lock);
+    }
+}
+
+void printLatencies(int engine) {
+    std::vector<double> & sorted = latencies[engine];
+    if (sorted.empty()) {
+        fprintf(stderr, "engine %s (%s): no moves, %d forfeits\n", engines[engine].name, engines[engine].path, forfeits[engine]);
+        return;
+    }
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0;
+    for (double latency : sorted) total += latency;
+    fprintf(stderr, "engine %s (%s): %zu moves, mean %.3fms, p50 %.3fms, p99 %.3fms, max %.3fms, %d forfeits\n",
+        engines[engine].name, engines[engine].path, sorted.size(), total / sorted.size(), sorted[sorted.size() / 2],
+        sorted[std::min(sorted.size() - 1, (size_t) (sorted.size() * 0.99))], sorted.back(), forfeits[engine]);
+}
+
+void init(int argc, char ** argv) {
+    signal(SIGPIPE, SIG_IGN);
+    if (argc > 1) engines[0].path = argv[1];
+    if (argc > 2) engines[1].path = argv[2];
+
+    char * gamesEnv = std::getenv("ARENA_GAMES");
+    if (gamesEnv) config.pairs = (std::max(1l, std::strtol(gamesEnv, NULL, 10)) + 1) / 2;
+    char * concurrencyEnv = std::getenv("ARENA_CONCURRENCY");
+    if (concurrencyEnv) config.concurrency = std::max(1l, std::strtol(concurrencyEnv, NULL, 10));
+    char * openingEnv = std::getenv("ARENA_OPENING_PLIES");
+    if (openingEnv) config.openingPlies = std::min(std::max(0l, std::strtol(openingEnv, NULL, 10)), 16l);
+    char * seedEnv = std::getenv("ARENA_SEED");
+    if (seedEnv) config.seed = std::strtoull(seedEnv, NULL, 10);
+    char * moveTimeoutEnv = std::getenv("ARENA_MOVE_TIMEOUT");
+    if (moveTimeoutEnv) config.moveTimeout = std::strtoul(moveTimeoutEnv, NULL, 10);
+    char * spareEnv = std::getenv("ARENA_SPARE_ENGINES");
+    if (spareEnv) config.spareEngines = std::max(0l, std::strtol(spareEnv, NULL, 10));
+    char * elo0Env = std::getenv("ARENA_ELO0");
+    if (elo0Env) config.elo0 = std::strtod(elo0Env, NULL);
+    char * elo1Env = std::getenv("ARENA_ELO1");
+    if (elo1Env) config.elo1 = std::strtod(elo1Env, NULL);
+    char * alphaEnv = std::getenv("ARENA_ALPHA");
+    if (alphaEnv) config.alpha = std::strtod(alphaEnv, NULL);
+    char * betaEnv = std::getenv("ARENA_BETA");
+    if (betaEnv) config.beta = std::strtod(betaEnv, NULL);
+    if (std::getenv("ARENA_NO_SPRT_STOP")) config.sprtStop = false;
+
+    const char * limitNames[][2] = { { "ARENA_TIME_MS", "SEARCH_TIME_MS" }, { "ARENA_NODES", "SEARCH_NODES" }, { "ARENA_DEPTH", "SEARCH_DEPTH" } };
+    for (auto & names : limitNames) {
+        char * value = std::getenv(names[0]);
+        if (value) config.limits.emplace_back(names[1], value);
+    }
+    if (config.limits.empty()) config.limits.emplace_back("SEARCH_TIME_MS", "100");
+    engines[0].environment = parseEnvironment(std::getenv("ARENA_ENV_A"));
+    engines[1].environment = parseEnvironment(std::getenv("ARENA_ENV_B"));
+}
+
+int main(int argc, char ** argv) {
+    init(argc, argv);
+    for (int i = 0; i < 2; i++) {
+        applyEnvironment(i);
+        bool ready = initEnginePool(&pools[i], engines[i].path, config.spareEngines, 0, WARMUP_REQUEST);
+        restoreEnvironment(i);
+        if (!ready) {
+            fprintf(stderr, "engine %s (%s) failed to start\n", engines[i].name, engines[i].path);
+            return 1;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> slots;
+    activeSlots = std::min(config.concurrency, config.pairs);
+    for (int i = 0; i < activeSlots; i++)
+        slots.emplace_back(slot);
+    refillPools();
+    for (std::thread & thread : slots) thread.join();
+    for (EnginePool & pool : pools) destroyEnginePool(&pool);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double lower, upper, llr;
+    double elo = matchScore.elo(lower, upper);
+    SprtState state = matchScore.sprt(config.elo0, config.elo1, config.alpha, config.beta, &llr);
+    fprintf(stderr, "%llu games in %.1fs: A %s vs B %s: +%llu =%llu -%llu, score %.3f\n", matchScore.games(), seconds,
+        engines[0].path, engines[1].path, matchScore.wins, matchScore.draws, matchScore.losses, matchScore.score());
+    fprintf(stderr, "elo %.1f, 95%% interval [%.1f, %.1f]\n", elo, lower, upper);
+    fprintf(stderr, "sprt elo0 %g elo1 %g alpha %g beta %g: llr %.2f in [%.2f, %.2f], %s\n", config.elo0, config.elo1,
+        config.alpha, config.beta, llr, std::log(config.beta / (1 - config.alpha)), std::log((1 - config.beta) / config.alpha),
+        state == SprtState::ACCEPT_H1 ? "H1 accepted" : state == SprtState::ACCEPT_H0 ? "H0 accepted" : "undecided");
+    printLatencies(0);
+    printLatencies(1);
+    return 0;
+}
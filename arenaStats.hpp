@@ -0,0 +1,70 @@
+#pragma once
+#include <cmath>
+
+/*
+    Match statistics for the arena, from the point of view of the first engine.
+
+    Games are scored 1, 1/2 and 0 and treated as independent trials (trinomial model). The Elo
+    estimate uses the logistic curve score = 1 / (1 + 10^(-elo / 400)), with a confidence interval
+    from the normal approximation of the mean score. The SPRT tests H0: elo = elo0 against
+    H1: elo = elo1 with the generalised (normal approximation) log-likelihood ratio used by common
+    engine testing frameworks: it accepts H1 once the LLR reaches log((1 - beta) / alpha) and H0
+    once it falls to log(beta / (1 - alpha)).
+*/
+
+enum class SprtState {
+    CONTINUE,
+    ACCEPT_H0, // Not better by elo1, at the requested error rates
+    ACCEPT_H1
+};
+
+inline double eloToScore(double elo) {
+    return 1 / (1 + std::pow(10, -elo / 400));
+}
+// Infinite for scores of 0 and 1
+inline double scoreToElo(double score) {
+    if (score <= 0) return -INFINITY;
+    if (score >= 1) return INFINITY;
+    return -400 * std::log10(1 / score - 1);
+}
+
+struct MatchScore {
+    unsigned long long wins = 0, draws = 0, losses = 0;
+
+    unsigned long long games() const {
+        return wins + draws + losses;
+    }
+    void add(double result) {
+        if (result > 0.75) wins++;
+        else if (result < 0.25) losses++;
+        else draws++;
+    }
+    double score() const {
+        return games() ? (wins + draws * 0.5) / games() : 0.5;
+    }
+    // Variance of a single game's result
+    double variance() const {
+        if (!games()) return 0;
+        double s = score();
+        return (wins * (1 - s) * (1 - s) + draws * (0.5 - s) * (0.5 - s) + losses * s * s) / games();
+    }
+    // Elo difference with the bounds of a two-sided interval, z = 1.96 for 95%
+    double elo(double & lower, double & upper, double z = 1.96) const {
+        double s = score(), margin = games() ? z * std::sqrt(variance() / games()) : 0;
+        lower = scoreToElo(s - margin);
+        upper = scoreToElo(s + margin);
+        return scoreToElo(s);
+    }
+    double logLikelihoodRatio(double elo0, double elo1) const {
+        double s0 = eloToScore(elo0), s1 = eloToScore(elo1), v = variance();
+        if (v <= 0) return 0; // All results equal so far, no information on the spread
+        return games() * (s1 - s0) * (2 * score() - s0 - s1) / (2 * v);
+    }
+    SprtState sprt(double elo0, double elo1, double alpha, double beta, double * llr = nullptr) const {
+        double ratio = logLikelihoodRatio(elo0, elo1);
+        if (llr) *llr = ratio;
+        if (ratio >= std::log((1 - beta) / alpha)) return SprtState::ACCEPT_H1;
+        if (ratio <= std::log(beta / (1 - alpha))) return SprtState::ACCEPT_H0;
+        return SprtState::CONTINUE;
+    }
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+/*
+    Fixed position suite for the bench mode of gobang (gobang bench).
+
+    Midgame positions are taken from engine self-play games after a random four-move opening;
+    tactical positions are three plies before the end of such games, with the eventual winner to
+    move. Each position is its move list from the first move as "x,y" cells separated by spaces,
+    and the side to move plays next as the bot. Changing this list changes the bench node
+    signature, so treat it like a test expectation.
+*/
+
+struct BenchPosition {
+    const char * name;
+    const char * moves;
+};
+
+constexpr BenchPosition benchPositions[] = {
+    { "midgame-01", "10,7 9,10 4,7 6,4 3,6 2,5 3,8 3,5 4,5 5,4 4,4 4,6" },
+    { "midgame-02", "10,4 10,10 5,10 4,8 4,11 6,9 4,9 3,8 5,8 2,8 1,8 6,7 2,9 3,10 3,9" },
+    { "midgame-03", "8,8 7,5 5,5 6,7 4,6 6,4 5,3 6,6 6,5 5,7 4,8 4,7 3,7 7,7 8,7 7,6 7,4 8,6" },
+    { "midgame-04", "7,4 9,8 8,9 9,5 6,5 9,6 9,7 8,3 5,6 4,7 6,7 7,8 8,7 7,7 6,8 6,6 8,8 8,6 7,6 8,10 5,5 10,4 11,3 5,4" },
+    { "midgame-05", "7,10 7,8 9,6 6,8 8,8 6,9 6,10 5,10 4,11 5,11 5,9 4,8 7,11" },
+    { "midgame-06", "5,4 7,4 9,8 7,10 10,9 8,7 9,10 8,11 9,9 9,7 8,9 11,9 9,12 9,11 10,11 7,8 10,8 10,10 12,8 11,8 7,11 11,7 6,12 8,10" },
+    { "midgame-07", "9,8 10,10 5,8 4,7 8,9 7,10 8,8 8,10 9,10 7,8 9,9 9,7 7,9 10,9" },
+    { "midgame-08", "6,5 5,7 5,8 4,6 6,8 4,8 6,6 6,7 4,7 3,9 3,6 2,5 7,8 8,8 6,9 7,10 8,7 9,6 7,6 9,8" },
+    { "midgame-09", "7,10 6,9 10,9 10,10 8,9 9,8 8,8 8,10 9,10 9,11 7,8 6,7 7,9 7,7 11,9 9,9 11,8 8,11 7,11 7,12 11,7 11,6 10,6" },
+    { "midgame-10", "8,4 5,6 4,7 7,9 4,5 4,4 5,4 3,6 4,6 4,8 5,7 3,7" },
+    { "midgame-11", "4,10 6,7 8,9 10,10 3,9 2,8 3,11 3,8 4,8 5,7 4,7 4,9 5,9 6,8 6,10" },
+    { "tactical-01", "10,7 9,10 4,7 6,4 3,6 2,5 3,8 3,5 4,5 5,4 4,4 4,6 5,6 6,5 6,7 3,4 8,9 7,8 9,8 7,10 2,9 1,10 11,6 12,5 4,3 5,7 6,8 6,9 4,2 4,1 2,7 8,10 1,8 0,9 6,10 2,4 1,3 8,11 9,12 7,9 7,11 7,6 7,7 10,10 11,10 10,9 11,8 7,12 6,13 5,5 3,7 7,3 8,2 4,8 1,7 0,7 8,7 9,7 11,9 11,7 3,9 3,10 1,6 4,9" },
+    { "tactical-02", "10,4 10,10 5,10 4,8 4,11 6,9 4,9 3,8 5,8 2,8 1,8 6,7 2,9 3,10 3,9 5,9 1,9 0,9 6,10 6,8 1,7 1,6 4,10 7,7 1,10 1,11 8,6 4,12 7,10 8,10 6,11 7,9 7,12 8,13 5,7 6,6 6,5" },
+    { "tactical-03", "8,8 7,5 5,5 6,7 4,6 6,4 5,3 6,6 6,5 5,7 4,8 4,7 3,7 7,7 8,7 7,6 7,4 8,6 5,6 5,8 5,2 5,4 8,5 9,7 10,8 8,4 9,3 9,6 10,6 7,9 7,8 6,8 6,3 4,1" },
+    { "tactical-04", "7,8 6,5 9,7 7,7 8,8 6,8 7,9 10,6 5,9 6,7 6,9 8,9 5,10 6,4 6,6 8,7 5,11 6,10" },
+    { "tactical-05", "7,4 9,8 8,9 9,5 6,5 9,6 9,7 8,3 5,6 4,7 6,7 7,8 8,7 7,7 6,8 6,6 8,8 8,6 7,6 8,10 5,5 10,4 11,3 5,4 4,5 7,5 5,7 7,9 5,8 5,9" },
+    { "tactical-06", "7,10 7,8 9,6 6,8 8,8 6,9 6,10 5,10 4,11 5,11 5,9 4,8 7,11 8,12 7,9 9,7 8,10 7,12 8,9 3,8 5,8 6,11 4,9 8,6 6,12 9,9 6,7 3,10 8,5 7,6 10,7 7,4 11,6 9,8 9,10 10,10 5,13 4,14 11,8 12,9 8,7 8,11 7,7 5,7 3,9 11,9 2,9 1,9 10,5" },
+    { "tactical-07", "6,4 5,7 4,5 8,6 5,4 4,6 6,3 3,6 7,4 8,4 7,2 8,1 6,2 6,5 5,2 8,5" },
+    { "tactical-08", "10,4 10,10 8,5 6,9 9,4 7,6 9,5 7,5 7,4 8,4 9,6 9,3" },
+    { "tactical-09", "8,7 6,4 9,10 4,4 7,4 5,5 7,3 7,5 7,2 6,6 7,7 6,5 7,1 7,0 6,7" },
+    { "tactical-10", "5,4 7,4 9,8 7,10 10,9 8,7 9,10 8,11 9,9 9,7 8,9 11,9 9,12 9,11 10,11 7,8 10,8 10,10 12,8 11,8 7,11 11,7 6,12 8,10 11,12 12,13 6,9 7,9 11,10" },
+    { "tactical-11", "9,8 10,10 5,8 4,7 8,9 7,10 8,8 8,10 9,10 7,8 9,9 9,7 7,9 10,9 10,8 9,11 5,9 6,9 5,10 5,11 11,9 8,11 7,11 5,7 11,8 12,8 11,7 11,6 6,7 12,6 4,9 3,10 4,8 8,12 3,7 6,10 11,11 11,10 8,13 6,11 7,6 8,5 6,12 12,7 12,9 10,5 2,6 1,5 9,4 9,6 8,7" },
+    { "tactical-12", "6,6 4,7 5,9 7,7 4,9 3,9 5,8 3,8 5,6 5,7 6,7 7,6 7,8 4,5 6,8 6,5" },
+};
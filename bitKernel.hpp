@@ -0,0 +1,262 @@
+#pragma once
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+#include "gobang.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define BIT_KERNEL_X86
+#define BIT_KERNEL_TARGET(FEATURES) __attribute__((target(FEATURES)))
+#define BIT_KERNEL_BMI_FEATURES "popcnt,bmi,lzcnt"
+#define BIT_KERNEL_BMI2_FEATURES "popcnt,bmi,bmi2,lzcnt"
+#endif
+
+/*
+    Bit-scan kernels used by ChessboardLineBinaryGrid.
+
+    Three builds of every kernel exist:
+        GENERIC: plain builtins, zero inputs handled explicitly, correct on any CPU;
+        BMI: the same bodies compiled with popcnt/bmi/lzcnt enabled, so they lower to popcnt/tzcnt/lzcnt;
+        BMI2: additionally uses bzhi/pext/pdep.
+    The build is selected once at startup from CPUID and may be overridden with the BIT_KERNEL
+    environment variable (generic, bmi, bmi2). An unsupported override falls back to the best build.
+
+    Callers bind a build at compile time through BitKernelOps<ISA>, so the kernels inline instead of
+    being called through a pointer. Code templated on the ISA is entered with dispatchBitKernel once
+    per coarse operation (a search slice, say): every build has its own entry compiled with the
+    build's target features and flatten, which inlines the whole call tree below it. BitKernelTable
+    holds the same kernels behind pointers, for tests and tools comparing the builds.
+*/
+enum class BitKernelISA {
+    GENERIC,
+    BMI,
+    BMI2,
+    SIZE
+};
+
+struct BitKernel {
+    const char * name;
+    // Count ones of value in bit range [start, end], both in range [0, 63]
+    uint64_t (*countOnes)(uint64_t value, int start, int end);
+    // Count trailing zeros, 64 for a zero value
+    uint64_t (*countTrailingZeros)(uint64_t value);
+    // Rotate value right by position, then count trailing (left side) and leading (right side) zeros
+    void (*countZerosAround)(uint64_t value, uint64_t position, uint64_t * leftZeroCount, uint64_t * rightZeroCount);
+    // Gather the bits of value selected by mask into the low bits (pext)
+    uint64_t (*extractBits)(uint64_t value, uint64_t mask);
+    // Scatter the low bits of value into the positions selected by mask (pdep)
+    uint64_t (*depositBits)(uint64_t value, uint64_t mask);
+};
+
+namespace BitKernelGeneric {
+    inline uint64_t rangeMask(int start, int end) {
+        if (end - start + 1 == 64) return -1;
+        return ((1ull << (end - start + 1)) - 1) << start;
+    }
+    inline uint64_t rotateRight(uint64_t value, uint64_t count) {
+        count &= 63;
+        return (value >> count) | (value << ((64 - count) & 63));
+    }
+    inline uint64_t countOnes(uint64_t value, int start, int end) {
+        return __builtin_popcountll(value & rangeMask(start, end));
+    }
+    inline uint64_t countTrailingZeros(uint64_t value) {
+        return value ? __builtin_ctzll(value) : 64;
+    }
+    inline uint64_t countLeadingZeros(uint64_t value) {
+        return value ? __builtin_clzll(value) : 64;
+    }
+    inline void countZerosAround(uint64_t value, uint64_t position, uint64_t * leftZeroCount, uint64_t * rightZeroCount) {
+        value = rotateRight(value, position);
+        *leftZeroCount = countTrailingZeros(value);
+        *rightZeroCount = countLeadingZeros(value);
+    }
+    inline uint64_t extractBits(uint64_t value, uint64_t mask) {
+        uint64_t result = 0;
+        for (uint64_t bit = 1; mask; bit <<= 1) {
+            if (value & mask & -mask) result |= bit;
+            mask &= mask - 1;
+        }
+        return result;
+    }
+    inline uint64_t depositBits(uint64_t value, uint64_t mask) {
+        uint64_t result = 0;
+        for (uint64_t bit = 1; mask; bit <<= 1) {
+            if (value & bit) result |= mask & -mask;
+            mask &= mask - 1;
+        }
+        return result;
+    }
+}
+
+#ifdef BIT_KERNEL_X86
+
+// Generic bodies inlined into functions compiled with the BMI feature set
+namespace BitKernelBMI {
+    BIT_KERNEL_TARGET(BIT_KERNEL_BMI_FEATURES) inline uint64_t countOnes(uint64_t value, int start, int end) {
+        return BitKernelGeneric::countOnes(value, start, end);
+    }
+    BIT_KERNEL_TARGET(BIT_KERNEL_BMI_FEATURES) inline uint64_t countTrailingZeros(uint64_t value) {
+        return BitKernelGeneric::countTrailingZeros(value);
+    }
+    BIT_KERNEL_TARGET(BIT_KERNEL_BMI_FEATURES) inline void countZerosAround(uint64_t value, uint64_t position, uint64_t * leftZeroCount, uint64_t * rightZeroCount) {
+        BitKernelGeneric::countZerosAround(value, position, leftZeroCount, rightZeroCount);
+    }
+}
+
+namespace BitKernelBMI2 {
+    BIT_KERNEL_TARGET(BIT_KERNEL_BMI2_FEATURES) inline uint64_t countOnes(uint64_t value, int start, int end) {
+        return _mm_popcnt_u64(_bzhi_u64(value >> start, end - start + 1));
+    }
+    BIT_KERNEL_TARGET(BIT_KERNEL_BMI2_FEATURES) inline uint64_t extractBits(uint64_t value, uint64_t mask) {
+        return _pext_u64(value, mask);
+    }
+    BIT_KERNEL_TARGET(BIT_KERNEL_BMI2_FEATURES) inline uint64_t depositBits(uint64_t value, uint64_t mask) {
+        return _pdep_u64(value, mask);
+    }
+}
+
+inline bool isBitKernelISASupported(BitKernelISA isa) {
+    unsigned eax, ebx, ecx, edx;
+    bool popcnt = false, lzcnt = false, bmi = false, bmi2 = false;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        popcnt = ecx & bit_POPCNT;
+    if (__get_cpuid(0x80000001, &eax, &ebx, &ecx, &edx))
+        lzcnt = ecx & bit_LZCNT;
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        bmi = ebx & bit_BMI;
+        bmi2 = ebx & bit_BMI2;
+    }
+    switch (isa) {
+        case BitKernelISA::GENERIC: return true;
+        case BitKernelISA::BMI: return popcnt && lzcnt && bmi;
+        case BitKernelISA::BMI2: return popcnt && lzcnt && bmi && bmi2;
+        default: return false;
+    }
+}
+
+inline const BitKernel BitKernelTable[SIZEOF_ENUMCLASS(BitKernelISA)] = {
+    { "generic", BitKernelGeneric::countOnes, BitKernelGeneric::countTrailingZeros, BitKernelGeneric::countZerosAround,
+        BitKernelGeneric::extractBits, BitKernelGeneric::depositBits },
+    { "bmi", BitKernelBMI::countOnes, BitKernelBMI::countTrailingZeros, BitKernelBMI::countZerosAround,
+        BitKernelGeneric::extractBits, BitKernelGeneric::depositBits },
+    { "bmi2", BitKernelBMI2::countOnes, BitKernelBMI::countTrailingZeros, BitKernelBMI::countZerosAround,
+        BitKernelBMI2::extractBits, BitKernelBMI2::depositBits },
+};
+
+#else
+
+inline bool isBitKernelISASupported(BitKernelISA isa) {
+    return isa == BitKernelISA::GENERIC;
+}
+
+inline const BitKernel BitKernelTable[SIZEOF_ENUMCLASS(BitKernelISA)] = {
+    { "generic", BitKernelGeneric::countOnes, BitKernelGeneric::countTrailingZeros, BitKernelGeneric::countZerosAround,
+        BitKernelGeneric::extractBits, BitKernelGeneric::depositBits },
+    { "generic", BitKernelGeneric::countOnes, BitKernelGeneric::countTrailingZeros, BitKernelGeneric::countZerosAround,
+        BitKernelGeneric::extractBits, BitKernelGeneric::depositBits },
+    { "generic", BitKernelGeneric::countOnes, BitKernelGeneric::countTrailingZeros, BitKernelGeneric::countZerosAround,
+        BitKernelGeneric::extractBits, BitKernelGeneric::depositBits },
+};
+
+#endif
+
+inline BitKernelISA selectBitKernelISA() {
+    char * bitKernelEnv = std::getenv("BIT_KERNEL");
+    if (bitKernelEnv) {
+        for (int isa = C2MI(BitKernelISA::GENERIC); isa < C2MI(BitKernelISA::SIZE); isa++) {
+            if (!strcmp(bitKernelEnv, BitKernelTable[isa].name) && isBitKernelISASupported(static_cast<BitKernelISA>(isa)))
+                return static_cast<BitKernelISA>(isa);
+        }
+    }
+    for (int isa = C2MI(BitKernelISA::SIZE) - 1; isa > C2MI(BitKernelISA::GENERIC); isa--) {
+        if (isBitKernelISASupported(static_cast<BitKernelISA>(isa)))
+            return static_cast<BitKernelISA>(isa);
+    }
+    return BitKernelISA::GENERIC;
+}
+
+// Chosen once during static initialization, before any board is searched
+inline BitKernelISA activeBitKernelISA = selectBitKernelISA();
+
+// Kernels of one build, bound at compile time; GENERIC, and every build off x86
+template <BitKernelISA ISA>
+struct BitKernelOps {
+    static uint64_t countOnes(uint64_t value, int start, int end) {
+        return BitKernelGeneric::countOnes(value, start, end);
+    }
+    static uint64_t countTrailingZeros(uint64_t value) {
+        return BitKernelGeneric::countTrailingZeros(value);
+    }
+    static void countZerosAround(uint64_t value, uint64_t position, uint64_t * leftZeroCount, uint64_t * rightZeroCount) {
+        BitKernelGeneric::countZerosAround(value, position, leftZeroCount, rightZeroCount);
+    }
+};
+
+// Entry into code templated on the ISA: function is called with std::integral_constant<BitKernelISA, ISA>
+template <BitKernelISA ISA>
+struct BitKernelEntry {
+    template <typename Function>
+    __attribute__((flatten)) static decltype(auto) call(Function && function) {
+        return function(std::integral_constant<BitKernelISA, ISA>());
+    }
+};
+
+#ifdef BIT_KERNEL_X86
+
+template <>
+struct BitKernelOps<BitKernelISA::BMI> {
+    BIT_KERNEL_TARGET(BIT_KERNEL_BMI_FEATURES) static uint64_t countOnes(uint64_t value, int start, int end) {
+        return BitKernelBMI::countOnes(value, start, end);
+    }
+    BIT_KERNEL_TARGET(BIT_KERNEL_BMI_FEATURES) static uint64_t countTrailingZeros(uint64_t value) {
+        return BitKernelBMI::countTrailingZeros(value);
+    }
+    BIT_KERNEL_TARGET(BIT_KERNEL_BMI_FEATURES) static void countZerosAround(uint64_t value, uint64_t position, uint64_t * leftZeroCount, uint64_t * rightZeroCount) {
+        BitKernelBMI::countZerosAround(value, position, leftZeroCount, rightZeroCount);
+    }
+};
+
+template <>
+struct BitKernelOps<BitKernelISA::BMI2> {
+    BIT_KERNEL_TARGET(BIT_KERNEL_BMI2_FEATURES) static uint64_t countOnes(uint64_t value, int start, int end) {
+        return BitKernelBMI2::countOnes(value, start, end);
+    }
+    BIT_KERNEL_TARGET(BIT_KERNEL_BMI2_FEATURES) static uint64_t countTrailingZeros(uint64_t value) {
+        return BitKernelBMI::countTrailingZeros(value);
+    }
+    BIT_KERNEL_TARGET(BIT_KERNEL_BMI2_FEATURES) static void countZerosAround(uint64_t value, uint64_t position, uint64_t * leftZeroCount, uint64_t * rightZeroCount) {
+        BitKernelBMI::countZerosAround(value, position, leftZeroCount, rightZeroCount);
+    }
+};
+
+template <>
+struct BitKernelEntry<BitKernelISA::BMI> {
+    template <typename Function>
+    BIT_KERNEL_TARGET(BIT_KERNEL_BMI_FEATURES) __attribute__((flatten)) static decltype(auto) call(Function && function) {
+        return function(std::integral_constant<BitKernelISA, BitKernelISA::BMI>());
+    }
+};
+
+template <>
+struct BitKernelEntry<BitKernelISA::BMI2> {
+    template <typename Function>
+    BIT_KERNEL_TARGET(BIT_KERNEL_BMI2_FEATURES) __attribute__((flatten)) static decltype(auto) call(Function && function) {
+        return function(std::integral_constant<BitKernelISA, BitKernelISA::BMI2>());
+    }
+};
+
+#endif
+
+// Run function with the kernels of build isa, see BitKernelEntry
+template <typename Function>
+decltype(auto) dispatchBitKernel(BitKernelISA isa, Function && function) {
+    switch (isa) {
+        case BitKernelISA::BMI2: return BitKernelEntry<BitKernelISA::BMI2>::call(function);
+        case BitKernelISA::BMI: return BitKernelEntry<BitKernelISA::BMI>::call(function);
+        default: return BitKernelEntry<BitKernelISA::GENERIC>::call(function);
+    }
+}
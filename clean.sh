@@ -1,2 +1,2 @@
 #!/bin/sh
-rm *.o main gobang
\ No newline at end of file
+rm *.o *.a main gobang gobangServer gridTest spawnBenchmark gobangLoad gameImport gameStore arena gridBenchmark
\ No newline at end of file
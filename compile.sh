@@ -17,10 +17,25 @@ fi
 export CFLAGS="$OPTIMIZE "
 export CXXFLAGS="$OPTIMIZE --std=c++17"
 
+# Libraries
+$CXX -c winJudge.cpp -o winJudge.o $CXXFLAGS
+ar rcs libwinjudge.a winJudge.o
+$CXX -c gobangEngine.cpp -o gobangEngine.o $CXXFLAGS
+ar rcs libgobang.a gobangEngine.o
+
 # Executables
-$CXX gobang.cpp -o gobang $CXXFLAGS
+$CXX gobang.cpp -o gobang $CXXFLAGS -pthread -L. -lgobang -lwinjudge
 $CC -c exec.c -o exec.o $CFLAGS
-$CXX exec.o main.cpp -o main $CXXFLAGS
+$CXX exec.o main.cpp -o main $CXXFLAGS -L. -lwinjudge
+$CXX gobangServer.cpp -o gobangServer $CXXFLAGS -pthread -L. -lgobang -lwinjudge
+$CXX gameImport.cpp -o gameImport $CXXFLAGS -pthread
+$CXX gameStore.cpp -o gameStore $CXXFLAGS
+$CXX exec.o arena.cpp -o arena $CXXFLAGS -pthread -L. -lwinjudge
+
+# Tests, checked with assert even in optimized builds
+$CXX exec.o gridTest.cpp -o gridTest $CXXFLAGS -UNDEBUG -pthread -L. -lgobang
 
-# Tests
-$CXX gridTest.cpp -o gridTest $CXXFLAGS
+# Benchmarks
+$CXX exec.o spawnBenchmark.cpp -o spawnBenchmark $CXXFLAGS
+$CXX gobangLoad.cpp -o gobangLoad $CXXFLAGS -pthread -L. -lwinjudge
+$CXX gridBenchmark.cpp -o gridBenchmark $CXXFLAGS
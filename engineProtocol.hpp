@@ -0,0 +1,308 @@
+#pragma once
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include "gobang.h"
+
+/*
+    Engine protocol messages without a JSON DOM.
+
+    Requests come in two shapes:
+        full history: {"requests":[{"x":..,"y":..},...],"responses":[...],"type":..}
+        incremental:  {"setup":{"board":"..."},"move":{"x":..,"y":..},"type":..}
+    parseEngineRequest decodes exactly this schema in one pass, straight into fixed arrays.
+    It returns false for anything else (unknown fields, escapes, non-integer numbers, ...),
+    in which case the caller falls back to jsoncpp and fills an EngineRequest from the DOM.
+    writeEngineResponse prints the reply into a caller-provided buffer, byte for byte what
+    Json::FastWriter produced for the same reply.
+
+    The binary protocol (BINARY_PROTOCOL) carries the same requests in frames:
+        header: payload length (uint16, little endian), type, flags
+        request payload, each part present when its flag is set:
+            BINARY_FLAG_HISTORY: move count (uint16, little endian), then one cell per move
+            BINARY_FLAG_SETUP: bot mask, then player mask, 225 bits each, cell i at bit i % 8 of byte i / 8
+            BINARY_FLAG_MOVE: one cell
+        response payload: one cell for a MOVE reply, the winner (ChessPiece) for a STATUS reply
+    A cell is x * SIZE + y, BINARY_CELL_NONE for a position off the board such as the pass (-1, -1).
+*/
+
+constexpr int ENGINE_MAX_MOVES = SIZE * SIZE + 1; // A full board plus the opening pass (-1, -1)
+
+struct EngineRequest {
+    int type = 0;
+    bool hasHistory = false; // "requests" present: full history protocol, otherwise incremental
+    int requestCount = 0, responseCount = 0;
+    ChessPosition requests[ENGINE_MAX_MOVES], responses[ENGINE_MAX_MOVES];
+    bool hasMove = false;
+    ChessPosition move;
+    bool hasSetup = false;
+    int boardLength = 0;
+    char board[SIZE * SIZE]; // '0' empty, '1' bot, '2' player, row by row
+
+    void clear() {
+        type = 0;
+        hasHistory = hasMove = hasSetup = false;
+        requestCount = responseCount = boardLength = 0;
+    }
+};
+
+enum class EngineResponseKind {
+    MOVE, // {"response":{"x":..,"y":..}}
+    STATUS // {"status":0} or {"prompt":"..","status":1}
+};
+
+struct EngineResponse {
+    EngineResponseKind kind = EngineResponseKind::STATUS;
+    ChessPosition move;
+    ChessPiece winner = EMPTY;
+    const char * prompt = NULL; // Required when winner is not EMPTY, printed without escaping
+};
+
+constexpr int BINARY_HEADER_SIZE = 4;
+constexpr int BINARY_MASK_SIZE = (SIZE * SIZE + 7) / 8;
+constexpr uint8_t BINARY_CELL_NONE = 0xff;
+constexpr uint8_t BINARY_FLAG_HISTORY = 1, BINARY_FLAG_SETUP = 2, BINARY_FLAG_MOVE = 4;
+// Largest request: full history, setup and move
+constexpr int BINARY_MAX_FRAME_SIZE = BINARY_HEADER_SIZE + 2 + 2 * ENGINE_MAX_MOVES + 2 * BINARY_MASK_SIZE + 1;
+
+class EngineRequestParser {
+    const char * cursor, * end;
+
+    void skipSpaces() {
+        while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\n' || *cursor == '\r')) cursor++;
+    }
+    bool consume(char expected) {
+        skipSpaces();
+        if (cursor >= end || *cursor != expected) return false;
+        cursor++;
+        return true;
+    }
+    // Plain strings only; escapes are left to the fallback
+    bool parseString(const char ** begin, int * length) {
+        if (!consume('"')) return false;
+        *begin = cursor;
+        while (cursor < end && *cursor != '"') {
+            if (*cursor == '\\') return false;
+            cursor++;
+        }
+        if (cursor >= end) return false;
+        *length = cursor - *begin;
+        cursor++;
+        return true;
+    }
+    bool parseKey(const char ** key, int * length) {
+        return parseString(key, length) && consume(':');
+    }
+    static bool isKey(const char * key, int length, const char * expected) {
+        return (int) strlen(expected) == length && !memcmp(key, expected, length);
+    }
+    bool parseInt(int * value) {
+        skipSpaces();
+        bool negative = cursor < end && *cursor == '-';
+        if (negative) cursor++;
+        if (cursor >= end || *cursor < '0' || *cursor > '9') return false;
+        long long result = 0;
+        while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+            result = result * 10 + (*cursor++ - '0');
+            if (result > 0x7fffffff) return false;
+        }
+        if (cursor < end && (*cursor == '.' || *cursor == 'e' || *cursor == 'E')) return false;
+        *value = negative ? -result : result;
+        return true;
+    }
+    // Parse "{...}" calling parseMember(key, length) for each member
+    template <typename Lambda>
+    bool parseObject(Lambda parseMember) {
+        if (!consume('{')) return false;
+        if (consume('}')) return true;
+        do {
+            const char * key;
+            int length;
+            if (!parseKey(&key, &length) || !parseMember(key, length)) return false;
+        } while (consume(','));
+        return consume('}');
+    }
+    bool parsePosition(ChessPosition * position) {
+        bool hasX = false, hasY = false;
+        bool parsed = parseObject([&](const char * key, int length) {
+            if (isKey(key, length, "x")) return hasX = parseInt(&position->x);
+            if (isKey(key, length, "y")) return hasY = parseInt(&position->y);
+            return false;
+        });
+        return parsed && hasX && hasY;
+    }
+    bool parsePositionArray(ChessPosition * positions, int * count) {
+        if (!consume('[')) return false;
+        *count = 0;
+        if (consume(']')) return true;
+        do {
+            if (*count >= ENGINE_MAX_MOVES || !parsePosition(&positions[(*count)++])) return false;
+        } while (consume(','));
+        return consume(']');
+    }
+    bool parseSetup(EngineRequest & request) {
+        bool hasBoard = false;
+        return parseObject([&](const char * key, int length) {
+            if (!isKey(key, length, "board")) return false;
+            const char * board;
+            int boardLength;
+            if (!parseString(&board, &boardLength) || boardLength > SIZE * SIZE) return false;
+            memcpy(request.board, board, boardLength);
+            request.boardLength = boardLength;
+            return hasBoard = true;
+        }) && hasBoard;
+    }
+
+public:
+    bool parse(const char * text, size_t length, EngineRequest & request) {
+        cursor = text;
+        end = text + length;
+        request.clear();
+        bool hasResponses = false;
+        bool parsed = parseObject([&](const char * key, int keyLength) {
+            if (isKey(key, keyLength, "type")) return parseInt(&request.type);
+            if (isKey(key, keyLength, "requests"))
+                return request.hasHistory = parsePositionArray(request.requests, &request.requestCount);
+            if (isKey(key, keyLength, "responses"))
+                return hasResponses = parsePositionArray(request.responses, &request.responseCount);
+            if (isKey(key, keyLength, "move")) return request.hasMove = parsePosition(&request.move);
+            if (isKey(key, keyLength, "setup")) return request.hasSetup = parseSetup(request);
+            return false;
+        });
+        skipSpaces();
+        if (!parsed || cursor != end) return false;
+        // Full history must alternate requests[0], responses[0], ..., requests[turnID]
+        if (request.hasHistory || hasResponses)
+            return request.hasHistory && request.requestCount == request.responseCount + 1;
+        return true;
+    }
+};
+
+inline bool parseEngineRequest(const char * text, size_t length, EngineRequest & request) {
+    EngineRequestParser parser;
+    return parser.parse(text, length, request);
+}
+
+// Returns the length written including the trailing newline, or 0 if the buffer is too small
+inline int writeEngineResponse(const EngineResponse & response, char * buffer, size_t size) {
+    int length;
+    if (response.kind == EngineResponseKind::MOVE)
+        length = snprintf(buffer, size, "{\"response\":{\"x\":%d,\"y\":%d}}\n", response.move.x, response.move.y);
+    else if (response.winner == EMPTY)
+        length = snprintf(buffer, size, "{\"status\":0}\n");
+    else
+        length = snprintf(buffer, size, "{\"prompt\":\"%s\",\"status\":1}\n", response.prompt);
+    return length > 0 && (size_t) length < size ? length : 0;
+}
+
+inline uint8_t encodeBinaryCell(const ChessPosition & position) {
+    if (position.x < 0 || position.y < 0 || position.x >= SIZE || position.y >= SIZE) return BINARY_CELL_NONE;
+    return position.x * SIZE + position.y;
+}
+
+inline bool decodeBinaryCell(uint8_t cell, ChessPosition * position) {
+    if (cell == BINARY_CELL_NONE) *position = ChessPosition(-1, -1);
+    else if (cell < SIZE * SIZE) *position = ChessPosition(cell / SIZE, cell % SIZE);
+    else return false;
+    return true;
+}
+
+inline int writeBinaryHeader(uint8_t * buffer, int payloadLength, uint8_t type, uint8_t flags) {
+    buffer[0] = payloadLength & 0xff;
+    buffer[1] = payloadLength >> 8;
+    buffer[2] = type;
+    buffer[3] = flags;
+    return BINARY_HEADER_SIZE + payloadLength;
+}
+
+// Payload length announced by a complete header
+inline int readBinaryPayloadLength(const uint8_t * header) {
+    return header[0] | header[1] << 8;
+}
+
+// Returns the frame length, buffer must hold BINARY_MAX_FRAME_SIZE bytes
+inline int encodeBinaryEngineRequest(const EngineRequest & request, uint8_t * buffer) {
+    uint8_t * payload = buffer + BINARY_HEADER_SIZE, * cursor = payload;
+    uint8_t flags = 0;
+    if (request.hasHistory) {
+        flags |= BINARY_FLAG_HISTORY;
+        int count = request.requestCount + request.responseCount;
+        *cursor++ = count & 0xff;
+        *cursor++ = count >> 8;
+        for (int i = 0; i < count; i++)
+            *cursor++ = encodeBinaryCell(i % 2 == 0 ? request.requests[i / 2] : request.responses[i / 2]);
+    }
+    if (request.hasSetup) {
+        flags |= BINARY_FLAG_SETUP;
+        memset(cursor, 0, 2 * BINARY_MASK_SIZE);
+        for (int i = 0; i < request.boardLength; i++) {
+            if (request.board[i] == '0' + BOT) cursor[i / 8] |= 1 << (i % 8);
+            else if (request.board[i] == '0' + PLAYER) cursor[BINARY_MASK_SIZE + i / 8] |= 1 << (i % 8);
+        }
+        cursor += 2 * BINARY_MASK_SIZE;
+    }
+    if (request.hasMove) {
+        flags |= BINARY_FLAG_MOVE;
+        *cursor++ = encodeBinaryCell(request.move);
+    }
+    return writeBinaryHeader(buffer, cursor - payload, request.type, flags);
+}
+
+// Decode the payload following header; false for malformed frames
+inline bool decodeBinaryEngineRequest(const uint8_t * header, const uint8_t * payload, EngineRequest & request) {
+    int length = readBinaryPayloadLength(header);
+    const uint8_t * cursor = payload, * end = payload + length;
+    uint8_t flags = header[3];
+    request.clear();
+    request.type = header[2];
+    if (flags & BINARY_FLAG_HISTORY) {
+        if (end - cursor < 2) return false;
+        int count = cursor[0] | cursor[1] << 8;
+        cursor += 2;
+        // Alternating requests[0], responses[0], ..., requests[turnID]
+        if (count % 2 == 0 || count > 2 * ENGINE_MAX_MOVES - 1 || end - cursor < count) return false;
+        request.hasHistory = true;
+        request.requestCount = count / 2 + 1;
+        request.responseCount = count / 2;
+        for (int i = 0; i < count; i++)
+            if (!decodeBinaryCell(*cursor++, i % 2 == 0 ? &request.requests[i / 2] : &request.responses[i / 2])) return false;
+    }
+    if (flags & BINARY_FLAG_SETUP) {
+        if (end - cursor < 2 * BINARY_MASK_SIZE) return false;
+        request.hasSetup = true;
+        request.boardLength = SIZE * SIZE;
+        for (int i = 0; i < SIZE * SIZE; i++) {
+            bool bot = cursor[i / 8] >> (i % 8) & 1, player = cursor[BINARY_MASK_SIZE + i / 8] >> (i % 8) & 1;
+            if (bot && player) return false;
+            request.board[i] = bot ? '0' + BOT : player ? '0' + PLAYER : '0' + EMPTY;
+        }
+        cursor += 2 * BINARY_MASK_SIZE;
+    }
+    if (flags & BINARY_FLAG_MOVE) {
+        if (end - cursor < 1) return false;
+        request.hasMove = decodeBinaryCell(*cursor++, &request.move);
+        if (!request.hasMove) return false;
+    }
+    return cursor == end;
+}
+
+// Returns the frame length, buffer must hold BINARY_HEADER_SIZE + 1 bytes
+inline int encodeBinaryEngineResponse(const EngineResponse & response, uint8_t * buffer) {
+    buffer[BINARY_HEADER_SIZE] = response.kind == EngineResponseKind::MOVE ? encodeBinaryCell(response.move) : (uint8_t) response.winner;
+    return writeBinaryHeader(buffer, 1, C2MI(response.kind), 0);
+}
+
+// Decode a complete response frame; the prompt is filled in by the caller if needed
+inline bool decodeBinaryEngineResponse(const uint8_t * frame, size_t size, EngineResponse & response) {
+    if (size != BINARY_HEADER_SIZE + 1 || readBinaryPayloadLength(frame) != 1) return false;
+    response = EngineResponse();
+    uint8_t value = frame[BINARY_HEADER_SIZE];
+    if (frame[2] == C2MI(EngineResponseKind::MOVE)) {
+        response.kind = EngineResponseKind::MOVE;
+        return decodeBinaryCell(value, &response.move);
+    }
+    if (frame[2] != C2MI(EngineResponseKind::STATUS) || value > PIECE_END) return false;
+    response.winner = static_cast<ChessPiece>(value);
+    return true;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <string>
+#include <algorithm>
+#include "jsoncpp/json.h"
+#include "engineProtocol.hpp"
+
+/*
+    jsoncpp fallback for requests outside the schema parseEngineRequest understands.
+    jsoncpp is compiled into whichever translation unit includes it, so include this header
+    from exactly one translation unit per executable.
+*/
+
+// Copy the protocol fields out of a DOM, with jsoncpp's defaults for missing members
+inline void buildEngineRequest(Json::Value & input, EngineRequest & request) {
+    request.clear();
+    request.type = input["type"].asInt();
+    request.hasHistory = input.isMember("requests");
+    if (request.hasHistory) {
+        int turnID = std::min<int>(input["responses"].size(), ENGINE_MAX_MOVES - 1);
+        request.requestCount = turnID + 1;
+        request.responseCount = turnID;
+        for (int i = 0; i <= turnID; i++) {
+            request.requests[i] = ChessPosition(input["requests"][i]["x"].asInt(), input["requests"][i]["y"].asInt());
+            if (i < turnID)
+                request.responses[i] = ChessPosition(input["responses"][i]["x"].asInt(), input["responses"][i]["y"].asInt());
+        }
+    }
+    request.hasSetup = input.isMember("setup");
+    if (request.hasSetup) {
+        std::string board = input["setup"]["board"].asString();
+        request.boardLength = std::min<int>(board.size(), SIZE * SIZE);
+        memcpy(request.board, board.data(), request.boardLength);
+    }
+    request.hasMove = input.isMember("move");
+    if (request.hasMove)
+        request.move = ChessPosition(input["move"]["x"].asInt(), input["move"]["y"].asInt());
+}
+
+// Decode one request line, falling back to jsoncpp; unparsable text becomes an empty type 0 request
+inline void parseEngineRequestLine(const char * line, size_t length, EngineRequest & request) {
+    if (parseEngineRequest(line, length, request)) return;
+    Json::Reader reader;
+    Json::Value input;
+    reader.parse(line, line + length, input);
+    buildEngineRequest(input, request);
+}
@@ -1,19 +1,35 @@
-#define _XOPEN_SOURCE 600
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <sys/syscall.h>
+#include <sys/resource.h>
 #include <sys/select.h>
 #include <sys/time.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <string.h>
 #include <errno.h>
 #include <poll.h>
 #include <time.h>
+#include <signal.h>
+#include <spawn.h>
+#include <pthread.h>
+#include "exec.h"
 
 #define INPUT 0 //Read End of Pipe
 #define OUTPUT 1 //Write End of Pipe
 
+#define PROMPT_INTERVAL_US 100000 // Elapsed time display refresh interval in prompt mode
+#define INITIAL_STDOUT_BUF_SIZE 0x1000
+
+// transferWithProcess flags
+#define TRANSFER_STOP_AT_NEWLINE 1 // Finish after the first newline instead of EOF
+#define TRANSFER_CLOSE_STDIN 2 // Close stdinFd once all input is written
+#define TRANSFER_PROMPT 4 // Display elapsed time while waiting
+#define TRANSFER_STOP_AT_FRAME 8 // Finish after one complete ENGINE_FRAME_HEADER_SIZE-prefixed frame
+
 static unsigned long long TimespecDiffInUs(const struct timespec * t1, const struct timespec * t2)
 {
     struct timespec diff;
@@ -36,103 +52,458 @@ static struct timespec getMonotonicClockTime() {
     return time;
 }
 
-int createProcessWithRedirectedStdinAndStdout(
-    const char * pathname, 
-    int * stdinFd, int * stdoutFd,
-    unsigned int alarmSecond
-) {
-    // Create stdin, stdout pipes
-    int stdinFdArr[2], stdoutFdArr[2];
-    if (pipe(stdinFdArr) == -1) {
-        perror("pipe Failed\n");
-        return 0;
-    }
-    if (pipe(stdoutFdArr) == -1) {
-        perror("pipe Failed\n");
+static void closePipe(int fdArr[2]) {
+    close(fdArr[INPUT]);
+    close(fdArr[OUTPUT]);
+}
+
+// pidfd becomes readable once the process exits; -1 on kernels without pidfd_open
+static int openPidFd(pid_t pid) {
+#ifdef SYS_pidfd_open
+    return syscall(SYS_pidfd_open, pid, 0);
+#else
+    return -1;
+#endif
+}
+
+// Soft limit raises SIGXCPU, one more second of CPU reaches the hard limit and SIGKILL
+static int limitCpuTime(pid_t pid, unsigned int cpuLimitSecond) {
+    if (!cpuLimitSecond) return 1;
+    struct rlimit limit = { .rlim_cur = cpuLimitSecond, .rlim_max = cpuLimitSecond + 1 };
+    if (prlimit(pid, RLIMIT_CPU, &limit, NULL) == -1) {
+        perror("prlimit failed");
         return 0;
     }
-    // Fork
+    return 1;
+}
+
+static pid_t forkEngine(const char * pathname, int stdinFdArr[2], int stdoutFdArr[2], const struct EngineSpawnOptions * options) {
     pid_t pid = fork();
     if (pid < 0) {
-        perror("fork Failed\n");
-        return 0;
+        perror("fork Failed");
     } else if (pid == 0) { // Child Process
-        // Close write end of stdin; read end of stdout
-        close(stdinFdArr[OUTPUT]);
-        close(stdoutFdArr[INPUT]);
         // dup2 pipe stdinFdArr[INPUT] & stdoutFdArr[OUTPUT] to stdin & stdout, respectively
+        // Duplicated fds drop close-on-exec, every other pipe end is closed by exec
         dup2(stdinFdArr[INPUT], 0);
         dup2(stdoutFdArr[OUTPUT], 1);
-        // Alarm
-        alarm(alarmSecond);
+        // Alarm and CPU limit
+        alarm(options->alarmSecond);
+        if (!limitCpuTime(0, options->cpuLimitSecond)) _exit(1);
         // Exec
-        int result;
-        result = execl(pathname, pathname, NULL);
+        execl(pathname, pathname, NULL);
         // On exec failed
-        perror("execvp failed\n");
-        exit(1);
-    } else { // Parent Process
-        // Close read end of stdin; write end of stdout
-        close(stdinFdArr[INPUT]);
-        close(stdoutFdArr[OUTPUT]);
-        // Write stdinFdArr[OUTPUT] & stdoutFdArr[INPUT] to stdinFd & stdoutFd, repectively
-        *stdinFd = stdinFdArr[OUTPUT];
-        *stdoutFd = stdoutFdArr[INPUT];
-        return 1;
+        perror("execl failed");
+        _exit(1);
     }
+    return pid;
 }
 
-int createProcessWithGivenStdinAndGetStdout(
-    const char * pathname, 
-    const char * stdinBuf, unsigned long stdinBufSize,
-    char * stdoutBuf, unsigned long stdoutBufSize, unsigned long * stdoutReadSize,
-    unsigned int alarmSecond, int prompt
+// posix_spawn avoids copying the parent's page tables (glibc uses CLONE_VFORK), so spawn
+// latency does not grow with the parent's size. The CPU limit is applied from the parent.
+static pid_t posixSpawnEngine(const char * pathname, int stdinFdArr[2], int stdoutFdArr[2], const struct EngineSpawnOptions * options) {
+    posix_spawn_file_actions_t fileActions;
+    int result = posix_spawn_file_actions_init(&fileActions);
+    if (!result) result = posix_spawn_file_actions_adddup2(&fileActions, stdinFdArr[INPUT], 0);
+    if (!result) result = posix_spawn_file_actions_adddup2(&fileActions, stdoutFdArr[OUTPUT], 1);
+    pid_t pid = -1;
+    if (!result) {
+        char * argv[] = { (char *) pathname, NULL };
+        result = posix_spawn(&pid, pathname, &fileActions, NULL, argv, environ);
+    }
+    posix_spawn_file_actions_destroy(&fileActions);
+    if (result) {
+        errno = result;
+        perror("posix_spawn failed");
+        return -1;
+    }
+    if (!limitCpuTime(pid, options->cpuLimitSecond)) {
+        kill(pid, SIGKILL);
+        waitpid(pid, NULL, 0);
+        return -1;
+    }
+    return pid;
+}
+
+int spawnEngineProcessWithOptions(
+    const char * pathname,
+    struct EngineProcess * process,
+    const struct EngineSpawnOptions * options
 ) {
-    int stdinFd, stdoutFd;
-    // Create Process
-    if (!createProcessWithRedirectedStdinAndStdout(pathname, &stdinFd, &stdoutFd, alarmSecond))
+    // Create stdin, stdout pipes, close-on-exec so sibling engines do not inherit each other's ends
+    int stdinFdArr[2], stdoutFdArr[2];
+    if (pipe2(stdinFdArr, O_CLOEXEC) == -1) {
+        perror("pipe Failed");
+        return 0;
+    }
+    if (pipe2(stdoutFdArr, O_CLOEXEC) == -1) {
+        perror("pipe Failed");
+        closePipe(stdinFdArr);
+        return 0;
+    }
+    pid_t pid;
+    if (options->method == ENGINE_SPAWN_POSIX_SPAWN)
+        pid = posixSpawnEngine(pathname, stdinFdArr, stdoutFdArr, options);
+    else
+        pid = forkEngine(pathname, stdinFdArr, stdoutFdArr, options);
+    if (pid < 0) {
+        closePipe(stdinFdArr);
+        closePipe(stdoutFdArr);
+        return 0;
+    }
+    // Close read end of stdin; write end of stdout
+    close(stdinFdArr[INPUT]);
+    close(stdoutFdArr[OUTPUT]);
+    process->pid = pid;
+    process->pidFd = openPidFd(pid);
+    process->stdinFd = stdinFdArr[OUTPUT];
+    process->stdoutFd = stdoutFdArr[INPUT];
+    return 1;
+}
+
+int spawnEngineProcess(
+    const char * pathname,
+    struct EngineProcess * process,
+    unsigned int alarmSecond
+) {
+    // Pending alarms do not survive posix_spawn, so only an alarm needs the fork path
+    struct EngineSpawnOptions options = {
+        .method = alarmSecond ? ENGINE_SPAWN_FORK : ENGINE_SPAWN_POSIX_SPAWN,
+        .alarmSecond = alarmSecond,
+        .cpuLimitSecond = 0,
+    };
+    return spawnEngineProcessWithOptions(pathname, process, &options);
+}
+
+int reapEngineProcess(struct EngineProcess * process, int * status, int block) {
+    int retCode;
+    pid_t result;
+    do {
+        result = waitpid(process->pid, &retCode, block ? 0 : WNOHANG);
+    } while (result == -1 && errno == EINTR);
+    if (result == -1) {
+        perror("waitpid failed");
+        return -1;
+    }
+    if (result == 0) return 0;
+    if (status) *status = retCode;
+    process->pid = -1;
+    return 1;
+}
+
+int waitAnyEngineProcess(struct EngineProcess * processes, int count, int timeoutMs) {
+    struct timespec startTime = getMonotonicClockTime();
+    struct pollfd * fds = malloc(sizeof(struct pollfd) * (count ? count : 1));
+    if (!fds) {
+        perror("malloc failed");
+        return -1;
+    }
+    int exited = -1, lastRound = 0;
+    while (exited == -1 && !lastRound) {
+        // Engines without a pidfd are checked with WNOHANG on every poll tick
+        int pollingWithoutPidFd = 0;
+        for (int i = 0; i < count; i++) {
+            fds[i].fd = processes[i].pid != -1 ? processes[i].pidFd : -1;
+            fds[i].events = POLLIN;
+            if (processes[i].pid != -1 && processes[i].pidFd == -1) {
+                pollingWithoutPidFd = 1;
+                int retCode;
+                if (waitpid(processes[i].pid, &retCode, WNOHANG | WNOWAIT) > 0) exited = i;
+            }
+        }
+        if (exited != -1) break;
+        struct timespec currentTime = getMonotonicClockTime();
+        long long elapsedMs = TimespecDiffInUs(&startTime, &currentTime) / 1000, waitMs = -1;
+        // Past the deadline the pidfds are still polled once, so a timeout of 0 checks without waiting
+        if (timeoutMs >= 0) {
+            waitMs = elapsedMs >= timeoutMs ? 0 : timeoutMs - elapsedMs;
+            lastRound = waitMs == 0;
+        }
+        if (pollingWithoutPidFd && (waitMs == -1 || waitMs > PROMPT_INTERVAL_US / 1000))
+            waitMs = PROMPT_INTERVAL_US / 1000;
+        int ready = poll(fds, count, waitMs);
+        if (ready == -1) {
+            if (errno == EINTR && !lastRound) continue;
+            if (errno != EINTR) perror("poll failed");
+            break;
+        }
+        for (int i = 0; i < count && exited == -1; i++)
+            if (fds[i].fd != -1 && fds[i].revents) exited = i;
+    }
+    free(fds);
+    return exited;
+}
+
+void closeEngineProcess(struct EngineProcess * process, int forceKill) {
+    // Closing stdin makes a keep-running engine leave its request loop
+    if (process->stdinFd != -1) close(process->stdinFd);
+    if (process->stdoutFd != -1) close(process->stdoutFd);
+    process->stdinFd = process->stdoutFd = -1;
+    if (process->pid != -1) {
+        if (forceKill) {
+#ifdef SYS_pidfd_send_signal
+            if (process->pidFd == -1 || syscall(SYS_pidfd_send_signal, process->pidFd, SIGKILL, NULL, 0) == -1)
+#endif
+                kill(process->pid, SIGKILL);
+        }
+        reapEngineProcess(process, NULL, 1);
+    }
+    if (process->pidFd != -1) close(process->pidFd);
+    process->pidFd = -1;
+}
+
+// Spawn and optionally warm up one engine; returns 0 if it could not be made ready
+static int spawnPooledEngine(struct EnginePool * pool, struct EngineProcess * process) {
+    if (!spawnEngineProcess(pool->pathname, process, pool->alarmSecond)) return 0;
+    if (!pool->warmupRequest) return 1;
+    char * responseBuf;
+    unsigned long responseSize;
+    if (!exchangeLineWithProcess(process->stdinFd, process->stdoutFd,
+            pool->warmupRequest, strlen(pool->warmupRequest), &responseBuf, &responseSize, 0, 0)) {
+        closeEngineProcess(process, 1);
+        return 0;
+    }
+    free(responseBuf);
+    return 1;
+}
+
+int initEnginePool(
+    struct EnginePool * pool,
+    const char * pathname, int capacity,
+    unsigned int alarmSecond, const char * warmupRequest
+) {
+    pool->pathname = pathname;
+    pool->warmupRequest = warmupRequest;
+    pool->alarmSecond = alarmSecond;
+    pool->capacity = capacity;
+    pool->readyCount = 0;
+    pool->ready = malloc(sizeof(struct EngineProcess) * (capacity ? capacity : 1));
+    if (!pool->ready) {
+        perror("malloc failed");
         return 0;
-    // Write to subprocess's stdin
-    if (write(stdinFd, stdinBuf, stdinBufSize) != stdinBufSize) {
-        perror("Write error or doesn't write all buffer");
+    }
+    return refillEnginePool(pool);
+}
+
+int refillEnginePool(struct EnginePool * pool) {
+    while (pool->readyCount < pool->capacity) {
+        if (!spawnPooledEngine(pool, &pool->ready[pool->readyCount])) return 0;
+        pool->readyCount++;
+    }
+    return 1;
+}
+
+int acquireEngineFromPool(struct EnginePool * pool, struct EngineProcess * process) {
+    while (pool->readyCount) {
+        *process = pool->ready[--pool->readyCount];
+        // Skip engines that died while waiting in the pool
+        if (reapEngineProcess(process, NULL, 0) == 0) return 1;
+        closeEngineProcess(process, 0);
+    }
+    // Pool drained, spawn on the critical path
+    return spawnPooledEngine(pool, process);
+}
+
+void destroyEnginePool(struct EnginePool * pool) {
+    while (pool->readyCount)
+        closeEngineProcess(&pool->ready[--pool->readyCount], 1);
+    free(pool->ready);
+    pool->ready = NULL;
+    pool->capacity = 0;
+}
+
+int createProcessWithRedirectedStdinAndStdout(
+    const char * pathname, 
+    int * stdinFd, int * stdoutFd,
+    unsigned int alarmSecond
+) {
+    struct EngineProcess process;
+    if (!spawnEngineProcess(pathname, &process, alarmSecond)) return 0;
+    if (process.pidFd != -1) close(process.pidFd);
+    *stdinFd = process.stdinFd;
+    *stdoutFd = process.stdoutFd;
+    return 1;
+}
+
+static void printElapsedTime(const struct timespec * startTime) {
+    struct timespec currentTime = getMonotonicClockTime();
+    unsigned long long timeDiff = TimespecDiffInUs(startTime, &currentTime);
+    printf("\rTime elapsed: %3lld.%06llds...", timeDiff / 1000000, timeDiff % 1000000);
+    fflush(stdout);
+}
+
+// write() that reports EPIPE without raising SIGPIPE: the signal is blocked for the call and one
+// raised by it is consumed before the mask is restored, so callers need not ignore SIGPIPE
+static ssize_t writeWithoutSigpipe(int fd, const void * buf, size_t count) {
+    sigset_t sigpipe, pending, oldMask;
+    sigemptyset(&sigpipe);
+    sigaddset(&sigpipe, SIGPIPE);
+    sigpending(&pending);
+    int alreadyPending = sigismember(&pending, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &sigpipe, &oldMask);
+    ssize_t result = write(fd, buf, count);
+    if (result == -1 && errno == EPIPE && !alreadyPending) {
+        struct timespec noWait = { 0, 0 };
+        while (sigtimedwait(&sigpipe, NULL, &noWait) == -1 && errno == EINTR);
+        errno = EPIPE;
+    }
+    pthread_sigmask(SIG_SETMASK, &oldMask, NULL);
+    return result;
+}
+
+// Write all of stdinBuf to stdinFd while reading stdoutFd into a growable buffer, until EOF
+// (or a newline with TRANSFER_STOP_AT_NEWLINE) or until timeoutUs (0 for none) has passed.
+// Waits in ppoll; the elapsed time display is refreshed from the poll timeout path.
+// On success *stdoutBuf is a malloc'd, NUL-terminated buffer the caller has to free. stdinFd is
+// closed with TRANSFER_CLOSE_STDIN, otherwise it gets its original (blocking) flags back on every path.
+static int transferWithProcess(
+    int stdinFd, const char * stdinBuf, unsigned long stdinBufSize,
+    int stdoutFd, char ** stdoutBuf, unsigned long * stdoutReadSize,
+    unsigned long long timeoutUs, int flags
+) {
+    struct timespec startTime = getMonotonicClockTime();
+    unsigned long written = 0, capacity = INITIAL_STDOUT_BUF_SIZE, size = 0;
+    int finished = 0;
+    char * buf = malloc(capacity + 1);
+    if (!buf) {
+        perror("malloc failed");
         return 0;
     }
-    // Close subprocess's stdin pipe on write end
-    if (close(stdinFd) == -1) {
-        perror("close failed on stdinFd");
+    // Non-blocking writes, so a large input never blocks while the subprocess waits for us to read
+    int stdinFlags = fcntl(stdinFd, F_GETFL);
+    if (stdinFlags == -1 || fcntl(stdinFd, F_SETFL, stdinFlags | O_NONBLOCK) == -1) {
+        perror("fcntl failed on stdinFd");
+        free(buf);
         return 0;
     }
-    if (prompt) {
-        struct timespec startTime = getMonotonicClockTime();
-        while (1) {
-            struct timespec currentTime = getMonotonicClockTime();
-            unsigned long long timeDiff = TimespecDiffInUs(&startTime, &currentTime);
-            printf("\rTime elapsed: %3lld.%06llds...", timeDiff / 1000000, timeDiff % 1000000);
-            fflush(stdout);
-            usleep(100000); // 0.1s
-            // Check whether data is available
-            if (poll(&(struct pollfd){ .fd = stdoutFd, .events = POLLIN }, 1, 0) == 1) {
-                if ((*stdoutReadSize = read(stdoutFd, stdoutBuf, stdoutBufSize)) == -1) {
-                    perror("read failed");
-                    return 0;
+    int stdinOpen = 1;
+    while (!finished) {
+        if (stdinOpen && written == stdinBufSize) {
+            if (flags & TRANSFER_CLOSE_STDIN) {
+                if (close(stdinFd) == -1) {
+                    perror("close failed on stdinFd");
+                    break;
                 }
+            } else if (fcntl(stdinFd, F_SETFL, stdinFlags) == -1) {
+                perror("fcntl failed on stdinFd");
                 break;
             }
+            stdinOpen = 0;
         }
-        printf("\r");
-    } else {
-        // Receive output from subprocess's stdout
-        if ((*stdoutReadSize = read(stdoutFd, stdoutBuf, stdoutBufSize)) == -1) {
-            perror("read failed");
-            return 0;
+        struct pollfd fds[2] = {
+            { .fd = stdinOpen ? stdinFd : -1, .events = POLLOUT },
+            { .fd = stdoutFd, .events = POLLIN },
+        };
+        // Sleep until a pipe is ready, the display has to be refreshed, or the deadline
+        struct timespec currentTime = getMonotonicClockTime();
+        unsigned long long elapsedUs = TimespecDiffInUs(&startTime, &currentTime), waitUs = -1;
+        if (timeoutUs) {
+            if (elapsedUs >= timeoutUs) {
+                fprintf(stderr, "subprocess did not reply in time\n");
+                break;
+            }
+            waitUs = timeoutUs - elapsedUs;
+        }
+        if ((flags & TRANSFER_PROMPT) && waitUs > PROMPT_INTERVAL_US) waitUs = PROMPT_INTERVAL_US;
+        struct timespec waitTime = { .tv_sec = waitUs / 1000000, .tv_nsec = waitUs % 1000000 * 1000 };
+        int ready = ppoll(fds, 2, waitUs == (unsigned long long) -1 ? NULL : &waitTime, NULL);
+        if (ready == -1) {
+            if (errno == EINTR) continue;
+            perror("ppoll failed");
+            break;
+        }
+        if (ready == 0) {
+            if (flags & TRANSFER_PROMPT) printElapsedTime(&startTime);
+            continue;
+        }
+        if (fds[0].revents) {
+            ssize_t result = writeWithoutSigpipe(stdinFd, stdinBuf + written, stdinBufSize - written);
+            if (result >= 0) written += result;
+            else if (errno == EPIPE) written = stdinBufSize; // Subprocess stopped reading, keep collecting its output
+            else if (errno != EAGAIN && errno != EINTR) {
+                perror("write failed");
+                break;
+            }
+        }
+        if (fds[1].revents) {
+            if (size == capacity) {
+                char * grown = realloc(buf, capacity * 2 + 1);
+                if (!grown) {
+                    perror("realloc failed");
+                    break;
+                }
+                buf = grown;
+                capacity *= 2;
+            }
+            ssize_t result = read(stdoutFd, buf + size, capacity - size);
+            if (result == -1) {
+                if (errno == EINTR || errno == EAGAIN) continue;
+                perror("read failed");
+                break;
+            }
+            if (result == 0) {
+                if (flags & (TRANSFER_STOP_AT_NEWLINE | TRANSFER_STOP_AT_FRAME)) {
+                    fprintf(stderr, "subprocess closed its stdout\n");
+                    break;
+                }
+                finished = 1;
+            }
+            size += result;
+            if ((flags & TRANSFER_STOP_AT_NEWLINE) && memchr(buf + size - result, '\n', result)) finished = 1;
+            if ((flags & TRANSFER_STOP_AT_FRAME) && size >= ENGINE_FRAME_HEADER_SIZE &&
+                size >= ENGINE_FRAME_HEADER_SIZE + ((unsigned char) buf[0] | (unsigned char) buf[1] << 8)) finished = 1;
         }
     }
-
-    // Recycle zombie subprocess
-    int retCode;
-    if (wait(&retCode) == -1) {
-        perror("wait failed");
+    if (flags & TRANSFER_PROMPT) printf("\r");
+    if (stdinOpen) {
+        if (flags & TRANSFER_CLOSE_STDIN) close(stdinFd);
+        else if (fcntl(stdinFd, F_SETFL, stdinFlags) == -1) perror("fcntl failed on stdinFd");
+    }
+    if (!finished) {
+        free(buf);
         return 0;
     }
+    buf[size] = '\0';
+    *stdoutBuf = buf;
+    *stdoutReadSize = size;
     return 1;
-}
\ No newline at end of file
+}
+
+int createProcessWithGivenStdinAndGetStdout(
+    const char * pathname, 
+    const char * stdinBuf, unsigned long stdinBufSize,
+    char ** stdoutBuf, unsigned long * stdoutReadSize,
+    unsigned int alarmSecond, unsigned int timeoutSecond, int prompt
+) {
+    struct EngineProcess process;
+    // Create Process
+    if (!spawnEngineProcess(pathname, &process, alarmSecond))
+        return 0;
+    // Write to subprocess's stdin, then receive its stdout until EOF
+    int result = transferWithProcess(process.stdinFd, stdinBuf, stdinBufSize, process.stdoutFd, stdoutBuf, stdoutReadSize,
+        timeoutSecond * 1000000ULL, TRANSFER_CLOSE_STDIN | (prompt ? TRANSFER_PROMPT : 0));
+    process.stdinFd = -1; // Closed by transferWithProcess
+
+    // Recycle this subprocess only, killing it if it outlived the deadline
+    closeEngineProcess(&process, !result);
+    return result;
+}
+
+int exchangeLineWithProcess(
+    int stdinFd, int stdoutFd,
+    const char * stdinBuf, unsigned long stdinBufSize,
+    char ** stdoutBuf, unsigned long * stdoutReadSize,
+    unsigned int timeoutSecond, int prompt
+) {
+    return transferWithProcess(stdinFd, stdinBuf, stdinBufSize, stdoutFd, stdoutBuf, stdoutReadSize,
+        timeoutSecond * 1000000ULL, TRANSFER_STOP_AT_NEWLINE | (prompt ? TRANSFER_PROMPT : 0));
+}
+
+int exchangeFrameWithProcess(
+    int stdinFd, int stdoutFd,
+    const char * stdinBuf, unsigned long stdinBufSize,
+    char ** stdoutBuf, unsigned long * stdoutReadSize,
+    unsigned int timeoutSecond, int prompt
+) {
+    return transferWithProcess(stdinFd, stdinBuf, stdinBufSize, stdoutFd, stdoutBuf, stdoutReadSize,
+        timeoutSecond * 1000000ULL, TRANSFER_STOP_AT_FRAME | (prompt ? TRANSFER_PROMPT : 0));
+}
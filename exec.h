@@ -1,16 +1,122 @@
 #pragma once
 
-extern "C"
+#ifdef __cplusplus
+#define EXEC_API extern "C"
+#else
+#define EXEC_API
+#endif
+
+#include <sys/types.h>
+
+// Binary frames start with a header whose first two bytes are the little-endian payload length
+#define ENGINE_FRAME_HEADER_SIZE 4
+
+// A spawned engine with its pipes; pidFd is -1 where pidfd_open is unavailable
+struct EngineProcess {
+    pid_t pid;
+    int pidFd;
+    int stdinFd, stdoutFd;
+};
+
+enum EngineSpawnMethod {
+    ENGINE_SPAWN_FORK, // fork + dup2 + execl, required for alarmSecond
+    ENGINE_SPAWN_POSIX_SPAWN // posix_spawn with file actions, no page-table copy of the parent
+};
+
+struct EngineSpawnOptions {
+    enum EngineSpawnMethod method;
+    unsigned int alarmSecond; // Wall-clock SIGALRM, fork path only; 0 for none
+    unsigned int cpuLimitSecond; // RLIMIT_CPU, works with both methods; 0 for none
+};
+
+// Engines spawned (and optionally warmed up with one request line) ahead of time
+struct EnginePool {
+    const char * pathname;
+    const char * warmupRequest; // NULL for none, otherwise one newline-terminated request
+    unsigned int alarmSecond;
+    int capacity, readyCount;
+    struct EngineProcess * ready;
+};
+
+EXEC_API
 int createProcessWithRedirectedStdinAndStdout(
     const char * pathname, 
     int * stdinFd, int * stdoutFd,
     unsigned int alarmSecond
 );
 
-extern "C"
+// Run pathname once: write stdinBuf, then collect stdout until EOF.
+// *stdoutBuf is malloc'd and NUL-terminated, free() it; timeoutSecond of 0 waits forever.
+EXEC_API
 int createProcessWithGivenStdinAndGetStdout(
     const char * pathname, 
     const char * stdinBuf, unsigned long stdinBufSize,
-    char * stdoutBuf, unsigned long stdoutBufSize, unsigned long * stdoutReadSize,
-    unsigned int alarmSecond, int prompt
-);
\ No newline at end of file
+    char ** stdoutBuf, unsigned long * stdoutReadSize,
+    unsigned int alarmSecond, unsigned int timeoutSecond, int prompt
+);
+
+// Send a request to a long-running process and collect its reply up to the first newline.
+// *stdoutBuf is malloc'd and NUL-terminated, free() it; timeoutSecond of 0 waits forever.
+// A process that stopped reading does not raise SIGPIPE, the unwritten rest of the request is dropped.
+EXEC_API
+int exchangeLineWithProcess(
+    int stdinFd, int stdoutFd,
+    const char * stdinBuf, unsigned long stdinBufSize,
+    char ** stdoutBuf, unsigned long * stdoutReadSize,
+    unsigned int timeoutSecond, int prompt
+);
+
+// Same as exchangeLineWithProcess for the binary protocol: collects exactly one frame
+EXEC_API
+int exchangeFrameWithProcess(
+    int stdinFd, int stdoutFd,
+    const char * stdinBuf, unsigned long stdinBufSize,
+    char ** stdoutBuf, unsigned long * stdoutReadSize,
+    unsigned int timeoutSecond, int prompt
+);
+
+// Uses posix_spawn unless an alarm is requested
+EXEC_API
+int spawnEngineProcess(
+    const char * pathname,
+    struct EngineProcess * process,
+    unsigned int alarmSecond
+);
+
+EXEC_API
+int spawnEngineProcessWithOptions(
+    const char * pathname,
+    struct EngineProcess * process,
+    const struct EngineSpawnOptions * options
+);
+
+// Reap this engine only; returns 1 once reaped, 0 if it is still running (block == 0), -1 on error
+EXEC_API
+int reapEngineProcess(struct EngineProcess * process, int * status, int block);
+
+// Wait up to timeoutMs (-1 forever) for any engine to exit; returns its index or -1.
+// The exited engine is not reaped, call reapEngineProcess or closeEngineProcess on it.
+EXEC_API
+int waitAnyEngineProcess(struct EngineProcess * processes, int count, int timeoutMs);
+
+// Close the pipes, optionally SIGKILL, then reap
+EXEC_API
+void closeEngineProcess(struct EngineProcess * process, int forceKill);
+
+EXEC_API
+int initEnginePool(
+    struct EnginePool * pool,
+    const char * pathname, int capacity,
+    unsigned int alarmSecond, const char * warmupRequest
+);
+
+// Spawn engines until the pool is full again, call it off the critical path
+EXEC_API
+int refillEnginePool(struct EnginePool * pool);
+
+// Take a ready engine, spawning one directly if the pool is empty
+EXEC_API
+int acquireEngineFromPool(struct EnginePool * pool, struct EngineProcess * process);
+
+EXEC_API
+void destroyEnginePool(struct EnginePool * pool);
@@ -0,0 +1,330 @@
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "gobang.h"
+#include "grid.hpp"
+#include "gameStore.hpp"
+
+/*
+    Streaming importer for external game collections.
+
+    Usage: gameImport [file...] (stdin when no file is given; files must be mappable)
+    Two formats are recognised from the first non-blank character of each file:
+        RIF XML ('<'): every <game> element with its <move> list and the bresult attribute
+            (1 black won, 0 white won, 0.5 draw);
+        coordinate lists: one game per line, moves written as a column letter a-o and a row 1-15
+            ("h8 i9 j10", spaces optional) or as 0-based engine coordinates "x,y"; '#' starts a comment.
+    a1 is the lower left corner, so the move h8 is ChessPosition(15 - 8, 'h' - 'a').
+
+    The file is mapped and cut into chunks of IMPORT_CHUNK_MB MiB (default 4). IMPORT_WORKERS threads
+    (default: hardware threads) parse chunks in parallel and replay every game on a ChessboardGrid;
+    a game belongs to the chunk its first byte is in. Valid games are written to stdout in file order,
+    one JSON line each: {"moves":[{"x":7,"y":7},...],"result":"black"|"white"|"draw"|"unknown"}.
+    With GAME_STORE set to a path, the games are appended to that game store (gameStore.hpp) instead.
+    Games with a move off the board, on an occupied cell, after a five, or a recorded result a five
+    contradicts are dropped and counted on stderr.
+*/
+
+enum class ImportError { NONE, NOTATION, OFF_BOARD, OCCUPIED, AFTER_FIVE, RESULT_MISMATCH, EMPTY, SIZE };
+const char * importErrorNames[] = { "", "bad notation", "off the board", "occupied cell", "move after five", "result mismatch", "no moves" };
+
+struct ImportStats {
+    uint64_t games = 0, moves = 0;
+    uint64_t errors[SIZEOF_ENUMCLASS(ImportError)] = {};
+    void add(const ImportStats & other) {
+        games += other.games;
+        moves += other.moves;
+        for (int i = 0; i < C2MI(ImportError::SIZE); i++) errors[i] += other.errors[i];
+    }
+};
+
+struct ImportConfig {
+    int workers = std::max(1u, std::thread::hardware_concurrency());
+    size_t chunkSize = 4 << 20;
+    const char * storePath = NULL;
+    GameStoreWriter * store = NULL;
+    bool storeFailed = false;
+} config;
+
+inline bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Decode the moves of [text, end) up to a '#' comment
+ImportError parseMoves(const char * text, const char * end, std::vector<ChessPosition> & moves) {
+    moves.clear();
+    while (text < end) {
+        char c = *text;
+        if (isBlank(c) || c == ',' || c == ';') {
+            text++;
+            continue;
+        }
+        if (c == '#') break;
+        int x, y;
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+            // Letter column and one or two digit row, "h10i9" reads as h10 i9
+            y = (c | 0x20) - 'a';
+            if (++text == end || *text < '0' || *text > '9') return ImportError::NOTATION;
+            int row = *text++ - '0';
+            if (text < end && *text >= '0' && *text <= '9' && row * 10 + (*text - '0') <= SIZE) row = row * 10 + (*text++ - '0');
+            x = SIZE - row;
+        } else if (c >= '0' && c <= '9') {
+            x = 0;
+            while (text < end && *text >= '0' && *text <= '9') x = x * 10 + (*text++ - '0');
+            if (text == end || *text != ',') return ImportError::NOTATION;
+            text++;
+            if (text == end || *text < '0' || *text > '9') return ImportError::NOTATION;
+            y = 0;
+            while (text < end && *text >= '0' && *text <= '9') y = y * 10 + (*text++ - '0');
+        } else {
+            return ImportError::NOTATION;
+        }
+        if (x < 0 || y < 0 || x >= SIZE || y >= SIZE) return ImportError::OFF_BOARD;
+        moves.emplace_back(x, y);
+    }
+    return moves.empty() ? ImportError::EMPTY : ImportError::NONE;
+}
+
+// Replay on a grid, black first; a five decides the result, which must agree with a recorded one
+ImportError replayGame(const std::vector<ChessPosition> & moves, GameStoreResult & result) {
+    ChessboardGrid grid;
+    GameStoreResult fiveResult = GameStoreResult::UNKNOWN;
+    for (size_t i = 0; i < moves.size(); i++) {
+        if (fiveResult != GameStoreResult::UNKNOWN) return ImportError::AFTER_FIVE;
+        ChessPiece piece = i % 2 == 0 ? PLAYER : BOT;
+        if (grid.get(moves[i].x, moves[i].y) != EMPTY) return ImportError::OCCUPIED;
+        grid.set(moves[i].x, moves[i].y, piece);
+        if (grid.isFiveAt(piece, moves[i].x, moves[i].y)) fiveResult = i % 2 == 0 ? GameStoreResult::BLACK : GameStoreResult::WHITE;
+    }
+    if (fiveResult != GameStoreResult::UNKNOWN) {
+        if (result != GameStoreResult::UNKNOWN && result != fiveResult) return ImportError::RESULT_MISMATCH;
+        result = fiveResult;
+    }
+    return ImportError::NONE;
+}
+
+struct ChunkParser {
+    const char * data, * fileEnd;
+    std::string output;
+    ImportStats stats;
+    std::vector<ChessPosition> moves;
+
+    void appendCoordinate(int value) {
+        if (value >= 10) output += '1';
+        output += '0' + value % 10;
+    }
+    void addGame(const char * movesBegin, const char * movesEnd, GameStoreResult result) {
+        ImportError error = parseMoves(movesBegin, movesEnd, moves);
+        if (error == ImportError::NONE) error = replayGame(moves, result);
+        if (error != ImportError::NONE) {
+            stats.errors[C2MI(error)]++;
+            return;
+        }
+        stats.games++;
+        stats.moves += moves.size();
+        if (config.store) { // Result, move count and cell bytes, appended to the store by the writing thread
+            output += (char) result;
+            output += (char) moves.size();
+            for (const ChessPosition & move : moves) output += (char) (move.x * SIZE + move.y);
+            return;
+        }
+        output += "{\"moves\":[";
+        for (size_t i = 0; i < moves.size(); i++) {
+            if (i) output += ',';
+            output += "{\"x\":";
+            appendCoordinate(moves[i].x);
+            output += ",\"y\":";
+            appendCoordinate(moves[i].y);
+            output += '}';
+        }
+        output += "],\"result\":\"";
+        output += gameStoreResultNames[C2MI(result)];
+        output += "\"}\n";
+    }
+    // Lines starting in [begin, end)
+    void parseLines(const char * begin, const char * end) {
+        const char * line = begin;
+        if (line > data && line[-1] != '\n') {
+            line = (const char *) memchr(line, '\n', fileEnd - line);
+            line = line ? line + 1 : fileEnd;
+        }
+        while (line < end) {
+            const char * lineEnd = (const char *) memchr(line, '\n', fileEnd - line);
+            if (!lineEnd) lineEnd = fileEnd;
+            const char * text = line;
+            while (text < lineEnd && isBlank(*text)) text++;
+            if (text < lineEnd && *text != '#') addGame(text, lineEnd, GameStoreResult::UNKNOWN);
+            line = lineEnd + 1;
+        }
+    }
+    const char * find(const char * from, const char * to, const char * pattern) {
+        const char * found = (const char *) memmem(from, to - from, pattern, strlen(pattern));
+        return found ? found : to;
+    }
+    // <game ...> elements whose tag starts in [begin, end)
+    void parseRif(const char * begin, const char * end) {
+        // Search a little past the end so that a tag starting right before it is not cut off
+        const char * tag = begin, * searchEnd = std::min(fileEnd, end + 4);
+        while ((tag = find(tag, searchEnd, "<game")) < end) {
+            const char * attributes = tag + 5;
+            tag = attributes;
+            if (attributes == fileEnd || !(isBlank(*attributes) || *attributes == '>' || *attributes == '/')) continue; // <games>
+            const char * tagEnd = find(attributes, fileEnd, ">");
+            if (tagEnd == fileEnd || tagEnd[-1] == '/') continue;
+            const char * gameEnd = find(tagEnd, fileEnd, "</game>");
+            GameStoreResult result = GameStoreResult::UNKNOWN;
+            const char * bresult = find(attributes, tagEnd, "bresult=\"");
+            if (bresult < tagEnd) {
+                double score = strtod(bresult + 9, NULL);
+                result = score == 1 ? GameStoreResult::BLACK : score == 0 ? GameStoreResult::WHITE : GameStoreResult::DRAW;
+            }
+            const char * movesBegin = find(tagEnd, gameEnd, "<move>");
+            if (movesBegin == gameEnd) {
+                stats.errors[C2MI(ImportError::EMPTY)]++;
+                continue;
+            }
+            movesBegin += 6;
+            addGame(movesBegin, find(movesBegin, gameEnd, "</move>"), result);
+        }
+    }
+};
+
+// Parse chunks on the workers and write their output in file order, at most 2 chunks per worker ahead
+ImportStats importMapped(const char * data, size_t size) {
+    bool rif = false;
+    for (size_t i = 0; i < size; i++) {
+        if (isBlank(data[i])) continue;
+        rif = data[i] == '<';
+        break;
+    }
+    size_t chunkCount = (size + config.chunkSize - 1) / config.chunkSize;
+    std::vector<std::string> outputs(chunkCount);
+    std::vector<bool> ready(chunkCount);
+    std::mutex mutex;
+    std::condition_variable changed;
+    size_t nextChunk = 0, written = 0;
+    ImportStats total;
+    auto work = [&] {
+        ChunkParser parser{ data, data + size };
+        while (true) {
+            size_t chunk;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&] { return nextChunk == chunkCount || nextChunk < written + 2 * config.workers; });
+                if (nextChunk == chunkCount) break;
+                chunk = nextChunk++;
+            }
+            const char * begin = data + chunk * config.chunkSize, * end = data + std::min(size, (chunk + 1) * config.chunkSize);
+            parser.output.clear();
+            if (rif) parser.parseRif(begin, end);
+            else parser.parseLines(begin, end);
+            std::lock_guard<std::mutex> lock(mutex);
+            outputs[chunk].swap(parser.output);
+            ready[chunk] = true;
+            changed.notify_all();
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        total.add(parser.stats);
+    };
+    std::vector<std::thread> threads;
+    for (int i = 0; i < config.workers; i++) threads.emplace_back(work);
+    while (written < chunkCount) {
+        std::string output;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&] { return ready[written]; });
+            output.swap(outputs[written]);
+        }
+        if (!config.store) fwrite(output.data(), 1, output.size(), stdout);
+        for (size_t i = 0; config.store && i < output.size(); i += 2 + (uint8_t) output[i + 1])
+            if (!config.store->addCells((const uint8_t *) output.data() + i + 2, (uint8_t) output[i + 1], (GameStoreResult) output[i]))
+                config.storeFailed = true;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            written++;
+        }
+        changed.notify_all();
+    }
+    for (std::thread & thread : threads) thread.join();
+    return total;
+}
+
+bool importFile(const char * path, ImportStats & stats, uint64_t & bytes) {
+    int fd = path ? open(path, O_RDONLY | O_CLOEXEC) : STDIN_FILENO;
+    struct stat status;
+    if (fd == -1 || fstat(fd, &status) == -1) {
+        perror(path ? path : "stdin");
+        if (fd > STDIN_FILENO) close(fd);
+        return false;
+    }
+    if (!S_ISREG(status.st_mode)) {
+        fprintf(stderr, "%s: not a regular file, cannot be mapped\n", path ? path : "stdin");
+        if (fd != STDIN_FILENO) close(fd);
+        return false;
+    }
+    if (status.st_size == 0) {
+        if (fd != STDIN_FILENO) close(fd);
+        return true;
+    }
+    void * mapped = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (fd != STDIN_FILENO) close(fd);
+    if (mapped == MAP_FAILED) {
+        perror(path ? path : "stdin");
+        return false;
+    }
+    madvise(mapped, status.st_size, MADV_SEQUENTIAL);
+    stats.add(importMapped((const char *) mapped, status.st_size));
+    bytes += status.st_size;
+    munmap(mapped, status.st_size);
+    return true;
+}
+
+void init() {
+    char * workersEnv = std::getenv("IMPORT_WORKERS");
+    if (workersEnv && std::strtol(workersEnv, NULL, 10) > 0) config.workers = std::strtol(workersEnv, NULL, 10);
+    char * chunkEnv = std::getenv("IMPORT_CHUNK_MB");
+    if (chunkEnv && std::strtol(chunkEnv, NULL, 10) > 0) config.chunkSize = (size_t) std::strtol(chunkEnv, NULL, 10) << 20;
+    config.storePath = std::getenv("GAME_STORE");
+}
+
+int main(int argc, char ** argv) {
+    init();
+    ImportStats stats;
+    uint64_t bytes = 0;
+    bool ok = true;
+    GameStoreWriter store;
+    if (config.storePath) {
+        if (!store.open(config.storePath)) {
+            perror(config.storePath);
+            return 1;
+        }
+        config.store = &store;
+    }
+    auto start = std::chrono::steady_clock::now();
+    if (argc < 2) ok = importFile(NULL, stats, bytes);
+    for (int i = 1; i < argc; i++) ok = importFile(argv[i], stats, bytes) && ok;
+    fflush(stdout);
+    if (config.store && (!store.flush() || config.storeFailed)) {
+        perror(config.storePath);
+        ok = false;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    uint64_t dropped = 0;
+    for (int i = 1; i < C2MI(ImportError::SIZE); i++) dropped += stats.errors[i];
+    fprintf(stderr, "%llu games, %llu moves imported, %llu dropped, %.1f MiB in %.2fs (%.1f MiB/s)\n",
+        (unsigned long long) stats.games, (unsigned long long) stats.moves, (unsigned long long) dropped,
+        bytes / 1048576.0, seconds, seconds > 0 ? bytes / 1048576.0 / seconds : 0);
+    for (int i = 1; i < C2MI(ImportError::SIZE); i++)
+        if (stats.errors[i]) fprintf(stderr, "    %s: %llu\n", importErrorNames[i], (unsigned long long) stats.errors[i]);
+    return ok ? 0 : 1;
+}
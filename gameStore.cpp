@@ -0,0 +1,118 @@
+#include <string>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "gobang.h"
+#include "gameStore.hpp"
+
+/*
+    Inspect and maintain a game store (see gameStore.hpp).
+
+    Usage:
+        gameStore stats <store>: games, positions and results
+        gameStore dump <store> [first] [count]: games as JSON lines, in the gameImport format plus metadata
+        gameStore sample <store> [count] [seed]: uniformly random positions as incremental engine requests,
+            with the side to move as the bot, ready for gobang's batch mode
+        gameStore reindex <store>: rebuild the index from the records
+*/
+
+void printJsonString(const char * text, int length) {
+    putchar('"');
+    for (int i = 0; i < length; i++) {
+        unsigned char c = text[i];
+        if (c == '"' || c == '\\') printf("\\%c", c);
+        else if (c < 0x20) printf("\\u%04x", c);
+        else putchar(c);
+    }
+    putchar('"');
+}
+
+int printStats(const GameStoreReader & store) {
+    unsigned long long positions = 0, results[SIZEOF_ENUMCLASS(GameStoreResult)] = {}, broken = 0;
+    int longest = 0;
+    GameStoreView game;
+    for (size_t i = 0; i < store.size(); i++) {
+        if (!store.game(i, game)) {
+            broken++;
+            continue;
+        }
+        positions += game.moveCount;
+        results[C2MI(game.result)]++;
+        longest = std::max(longest, game.moveCount);
+    }
+    printf("%zu games, %llu positions, average %.1f moves, longest %d\n", store.size(), positions,
+        store.size() ? (double) positions / store.size() : 0.0, longest);
+    for (int i = 0; i < C2MI(GameStoreResult::SIZE); i++)
+        printf("    %s: %llu\n", gameStoreResultNames[i], results[i]);
+    if (broken) printf("    broken index entries: %llu\n", broken);
+    return broken ? 1 : 0;
+}
+
+int dumpGames(const GameStoreReader & store, size_t first, size_t count) {
+    GameStoreView game;
+    for (size_t i = first; i < store.size() && i - first < count; i++) {
+        if (!store.game(i, game)) {
+            fprintf(stderr, "game %zu: broken index entry\n", i);
+            return 1;
+        }
+        printf("{\"moves\":[");
+        for (int k = 0; k < game.moveCount; k++)
+            printf("%s{\"x\":%d,\"y\":%d}", k ? "," : "", game.move(k).x, game.move(k).y);
+        printf("],\"result\":\"%s\"", gameStoreResultNames[C2MI(game.result)]);
+        if (game.metadataLength) {
+            printf(",\"metadata\":");
+            printJsonString(game.metadata, game.metadataLength);
+        }
+        printf("}\n");
+    }
+    return 0;
+}
+
+int samplePositions(const GameStoreReader & store, size_t count, unsigned long long seed) {
+    std::mt19937_64 generator(seed);
+    GameStoreView game;
+    size_t gameIndex;
+    int ply;
+    for (size_t i = 0; i < count; i++) {
+        if (!store.samplePosition(generator, gameIndex, ply) || !store.game(gameIndex, game)) {
+            fprintf(stderr, "no position to sample\n");
+            return 1;
+        }
+        // The side about to play move ply is the bot
+        char board[SIZE * SIZE + 1];
+        memset(board, '0', SIZE * SIZE);
+        board[SIZE * SIZE] = 0;
+        for (int k = 0; k < ply; k++)
+            board[game.cells[k]] = (ply - k) % 2 == 0 ? '0' + BOT : '0' + PLAYER;
+        printf("{\"setup\":{\"board\":\"%s\"}}\n", board);
+    }
+    return 0;
+}
+
+int main(int argc, char ** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s stats|dump|sample|reindex <store> [arguments]\n", argv[0]);
+        return 2;
+    }
+    std::string command = argv[1], path = argv[2];
+    if (command == "reindex") {
+        if (!rebuildGameStoreIndex(path)) {
+            perror(path.c_str());
+            return 1;
+        }
+        return 0;
+    }
+    GameStoreReader store;
+    if (!store.open(path)) {
+        fprintf(stderr, "%s: not a game store\n", path.c_str());
+        return 1;
+    }
+    if (command == "stats") return printStats(store);
+    if (command == "dump")
+        return dumpGames(store, argc > 3 ? std::strtoull(argv[3], NULL, 10) : 0, argc > 4 ? std::strtoull(argv[4], NULL, 10) : SIZE_MAX);
+    if (command == "sample")
+        return samplePositions(store, argc > 3 ? std::strtoull(argv[3], NULL, 10) : 1, argc > 4 ? std::strtoull(argv[4], NULL, 10) : 0);
+    fprintf(stderr, "unknown command %s\n", command.c_str());
+    return 2;
+}
@@ -0,0 +1,311 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "gobang.h"
+
+/*
+    Compact binary game store shared by self-play, tuning and analysis tools.
+
+    A store is two files, each starting with an 8-byte magic: path holds the game records and
+    path + ".idx" one uint64 file offset per game, so game i is found in O(1). A record is a
+    GameStoreRecordHeader followed by moveCount cell bytes (x * SIZE + y as in the binary engine
+    protocol, black first) and metadataLength bytes of free-form metadata. Integers are stored in
+    host byte order (little-endian on every supported target).
+
+    Writers buffer records and append a batch under an exclusive flock on the record file: records
+    first, then their offsets to the index, so several producer processes can share one store and
+    an index entry never points at a partial record. rebuildGameStoreIndex recreates the index from
+    the records alone: every whole, well-formed record is indexed, including those a crashed writer
+    left without index entries, and the scan stops at a partial or corrupt tail. Readers map both
+    files and see the games that were indexed when they opened the store or last called refresh.
+*/
+
+constexpr char GAME_STORE_RECORD_MAGIC[8] = { 'G', 'O', 'B', 'G', 'A', 'M', 'E', '1' };
+constexpr char GAME_STORE_INDEX_MAGIC[8] = { 'G', 'O', 'B', 'I', 'N', 'D', 'X', '1' };
+constexpr size_t GAME_STORE_MAGIC_SIZE = 8;
+constexpr int GAME_STORE_MAX_MOVES = SIZE * SIZE;
+
+enum class GameStoreResult : uint8_t {
+    UNKNOWN,
+    BLACK, // First mover won
+    WHITE,
+    DRAW,
+    SIZE
+};
+
+inline const char * gameStoreResultNames[SIZEOF_ENUMCLASS(GameStoreResult)] = { "unknown", "black", "white", "draw" };
+
+struct GameStoreRecordHeader {
+    uint16_t moveCount;
+    uint16_t metadataLength;
+    uint8_t result; // GameStoreResult
+    uint8_t flags; // Reserved, 0
+    uint16_t reserved;
+};
+static_assert(sizeof(GameStoreRecordHeader) == 8, "record header is part of the file format");
+
+inline std::string gameStoreIndexPath(const std::string & path) {
+    return path + ".idx";
+}
+
+// Write the magic into a file that is still empty; call with the store lock held
+inline bool initGameStoreFile(int fd, const char * magic) {
+    struct stat status;
+    if (fstat(fd, &status) == -1) return false;
+    if (status.st_size >= (off_t) GAME_STORE_MAGIC_SIZE) return true;
+    return pwrite(fd, magic, GAME_STORE_MAGIC_SIZE, 0) == (ssize_t) GAME_STORE_MAGIC_SIZE;
+}
+
+inline bool writeFully(int fd, const void * data, size_t size, off_t offset) {
+    const char * cursor = (const char *) data;
+    while (size) {
+        ssize_t written = pwrite(fd, cursor, size, offset);
+        if (written <= 0) {
+            if (written == -1 && errno == EINTR) continue;
+            return false;
+        }
+        cursor += written;
+        offset += written;
+        size -= written;
+    }
+    return true;
+}
+
+class GameStoreWriter {
+    int recordFd = -1, indexFd = -1;
+    std::string pending; // Records not yet appended
+    std::vector<uint64_t> pendingOffsets; // Their offsets within pending
+
+public:
+    static constexpr size_t FLUSH_SIZE = 1 << 20; // add flushes once this much is pending
+
+    GameStoreWriter() = default;
+    GameStoreWriter(const GameStoreWriter &) = delete;
+    GameStoreWriter & operator =(const GameStoreWriter &) = delete;
+    ~GameStoreWriter() {
+        close();
+    }
+    // Open or create the store at path
+    bool open(const std::string & path) {
+        close();
+        recordFd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        indexFd = ::open(gameStoreIndexPath(path).c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (recordFd == -1 || indexFd == -1 || flock(recordFd, LOCK_EX) == -1) {
+            close();
+            return false;
+        }
+        bool initialized = initGameStoreFile(recordFd, GAME_STORE_RECORD_MAGIC) && initGameStoreFile(indexFd, GAME_STORE_INDEX_MAGIC);
+        flock(recordFd, LOCK_UN);
+        if (!initialized) close();
+        return initialized;
+    }
+    // Queue one game; moves off the board or more than GAME_STORE_MAX_MOVES are rejected
+    bool add(const ChessPosition * moves, int moveCount, GameStoreResult result, const char * metadata = "", size_t metadataLength = 0) {
+        if (moveCount < 0 || moveCount > GAME_STORE_MAX_MOVES) return false;
+        uint8_t cells[GAME_STORE_MAX_MOVES];
+        for (int i = 0; i < moveCount; i++) {
+            if (moves[i].x < 0 || moves[i].y < 0 || moves[i].x >= SIZE || moves[i].y >= SIZE) return false;
+            cells[i] = moves[i].x * SIZE + moves[i].y;
+        }
+        return addCells(cells, moveCount, result, metadata, metadataLength);
+    }
+    // Queue one game given as cell bytes
+    bool addCells(const uint8_t * cells, int moveCount, GameStoreResult result, const char * metadata = "", size_t metadataLength = 0) {
+        if (moveCount < 0 || moveCount > GAME_STORE_MAX_MOVES || metadataLength > UINT16_MAX) return false;
+        for (int i = 0; i < moveCount; i++)
+            if (cells[i] >= SIZE * SIZE) return false;
+        GameStoreRecordHeader header = { (uint16_t) moveCount, (uint16_t) metadataLength, (uint8_t) result, 0, 0 };
+        pendingOffsets.push_back(pending.size());
+        pending.append((const char *) &header, sizeof(header));
+        pending.append((const char *) cells, moveCount);
+        pending.append(metadata, metadataLength);
+        return pending.size() < FLUSH_SIZE || flush();
+    }
+    // Append the queued games to the store
+    bool flush() {
+        if (pending.empty()) return true;
+        if (recordFd == -1 || flock(recordFd, LOCK_EX) == -1) return false;
+        struct stat recordStatus, indexStatus;
+        bool written = fstat(recordFd, &recordStatus) != -1 && fstat(indexFd, &indexStatus) != -1;
+        if (written) {
+            std::vector<uint64_t> offsets(pendingOffsets.size());
+            for (size_t i = 0; i < offsets.size(); i++) offsets[i] = recordStatus.st_size + pendingOffsets[i];
+            written = writeFully(recordFd, pending.data(), pending.size(), recordStatus.st_size) &&
+                writeFully(indexFd, offsets.data(), offsets.size() * sizeof(uint64_t), indexStatus.st_size);
+            // Roll back a partial batch, so that the records stay parseable from the start
+            if (!written && (ftruncate(recordFd, recordStatus.st_size) != 0 || ftruncate(indexFd, indexStatus.st_size) != 0))
+                perror("game store rollback failed");
+        }
+        flock(recordFd, LOCK_UN);
+        pending.clear();
+        pendingOffsets.clear();
+        return written;
+    }
+    void close() {
+        if (recordFd != -1) flush();
+        for (int * fd : { &recordFd, &indexFd }) {
+            if (*fd != -1) ::close(*fd);
+            *fd = -1;
+        }
+        pending.clear();
+        pendingOffsets.clear();
+    }
+};
+
+struct GameStoreView {
+    const uint8_t * cells;
+    int moveCount;
+    GameStoreResult result;
+    const char * metadata;
+    int metadataLength;
+
+    ChessPosition move(int i) const {
+        return ChessPosition(cells[i] / SIZE, cells[i] % SIZE);
+    }
+};
+
+class GameStoreReader {
+    std::string path;
+    const uint8_t * records = nullptr;
+    size_t recordsSize = 0;
+    const uint64_t * index = nullptr;
+    size_t indexSize = 0;
+    size_t gameCount = 0;
+
+    static const void * mapFile(const std::string & filePath, size_t & size) {
+        int fd = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat status;
+        if (fd == -1 || fstat(fd, &status) == -1 || status.st_size < (off_t) GAME_STORE_MAGIC_SIZE) {
+            if (fd != -1) ::close(fd);
+            return nullptr;
+        }
+        size = status.st_size;
+        void * mapped = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        return mapped == MAP_FAILED ? nullptr : mapped;
+    }
+    void unmap() {
+        if (records) munmap((void *) records, recordsSize);
+        if (index) munmap((void *) index, indexSize);
+        records = nullptr;
+        index = nullptr;
+        gameCount = 0;
+    }
+
+public:
+    GameStoreReader() = default;
+    GameStoreReader(const GameStoreReader &) = delete;
+    GameStoreReader & operator =(const GameStoreReader &) = delete;
+    ~GameStoreReader() {
+        unmap();
+    }
+    bool open(const std::string & storePath) {
+        path = storePath;
+        return refresh();
+    }
+    // Map the store again to see games appended since it was opened; the index is mapped first,
+    // so every entry it holds points into the record mapping
+    bool refresh() {
+        unmap();
+        index = (const uint64_t *) mapFile(gameStoreIndexPath(path), indexSize);
+        records = (const uint8_t *) mapFile(path, recordsSize);
+        if (!index || !records || memcmp(index, GAME_STORE_INDEX_MAGIC, GAME_STORE_MAGIC_SIZE) ||
+            memcmp(records, GAME_STORE_RECORD_MAGIC, GAME_STORE_MAGIC_SIZE)) {
+            unmap();
+            return false;
+        }
+        gameCount = (indexSize - GAME_STORE_MAGIC_SIZE) / sizeof(uint64_t);
+        return true;
+    }
+    size_t size() const {
+        return gameCount;
+    }
+    // Game i in O(1); false for an index entry that does not point at a whole record
+    bool game(size_t i, GameStoreView & view) const {
+        if (i >= gameCount) return false;
+        uint64_t offset = index[1 + i];
+        GameStoreRecordHeader header;
+        if (offset < GAME_STORE_MAGIC_SIZE || offset + sizeof(header) > recordsSize) return false;
+        memcpy(&header, records + offset, sizeof(header));
+        if (offset + sizeof(header) + header.moveCount + header.metadataLength > recordsSize) return false;
+        view.cells = records + offset + sizeof(header);
+        view.moveCount = header.moveCount;
+        view.result = header.result < C2MI(GameStoreResult::SIZE) ? (GameStoreResult) header.result : GameStoreResult::UNKNOWN;
+        view.metadata = (const char *) view.cells + header.moveCount;
+        view.metadataLength = header.metadataLength;
+        return true;
+    }
+    // Uniformly random position over all games: the one before move ply of game gameIndex.
+    // Draws a game and a ply below GAME_STORE_MAX_MOVES until the ply lies inside the game,
+    // so the expected cost is constant (GAME_STORE_MAX_MOVES / average length draws)
+    template<class Generator>
+    bool samplePosition(Generator & generator, size_t & gameIndex, int & ply) const {
+        if (!gameCount) return false;
+        for (int attempt = 0; attempt < 1 << 16; attempt++) {
+            gameIndex = generator() % gameCount;
+            ply = generator() % GAME_STORE_MAX_MOVES;
+            GameStoreView view;
+            if (game(gameIndex, view) && ply < view.moveCount) return true;
+        }
+        return false;
+    }
+};
+
+// Whether a record that was never indexed is one a writer could have produced
+inline bool isGameStoreRecordValid(const GameStoreRecordHeader & header, const uint8_t * cells) {
+    if (header.moveCount > GAME_STORE_MAX_MOVES || header.result >= C2MI(GameStoreResult::SIZE) || header.flags || header.reserved)
+        return false;
+    for (int i = 0; i < header.moveCount; i++)
+        if (cells[i] >= SIZE * SIZE) return false;
+    return true;
+}
+
+// Recreate the index of path from its records, after a writer crashed between the two appends
+inline bool rebuildGameStoreIndex(const std::string & path) {
+    int recordFd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (recordFd == -1) return false;
+    int indexFd = ::open(gameStoreIndexPath(path).c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (indexFd == -1 || flock(recordFd, LOCK_EX) == -1) {
+        ::close(recordFd);
+        if (indexFd != -1) ::close(indexFd);
+        return false;
+    }
+    std::vector<uint64_t> offsets;
+    offsets.push_back(0);
+    memcpy(offsets.data(), GAME_STORE_INDEX_MAGIC, GAME_STORE_MAGIC_SIZE);
+    struct stat status;
+    bool rebuilt = fstat(recordFd, &status) != -1 && status.st_size >= (off_t) GAME_STORE_MAGIC_SIZE;
+    if (rebuilt) {
+        void * mapped = mmap(NULL, status.st_size, PROT_READ, MAP_SHARED, recordFd, 0);
+        rebuilt = mapped != MAP_FAILED;
+        if (rebuilt) {
+            const uint8_t * records = (const uint8_t *) mapped;
+            rebuilt = !memcmp(records, GAME_STORE_RECORD_MAGIC, GAME_STORE_MAGIC_SIZE);
+            uint64_t offset = GAME_STORE_MAGIC_SIZE;
+            GameStoreRecordHeader header;
+            while (rebuilt && offset + sizeof(header) <= (uint64_t) status.st_size) {
+                memcpy(&header, records + offset, sizeof(header));
+                uint64_t next = offset + sizeof(header) + header.moveCount + header.metadataLength;
+                if (next > (uint64_t) status.st_size) break; // Partial record at the end
+                if (!isGameStoreRecordValid(header, records + offset + sizeof(header))) break; // Corrupt tail, nothing after it can be framed
+                offsets.push_back(offset);
+                offset = next;
+            }
+            munmap(mapped, status.st_size);
+        }
+    }
+    rebuilt = rebuilt && ftruncate(indexFd, 0) == 0 && writeFully(indexFd, offsets.data(), offsets.size() * sizeof(uint64_t), 0);
+    flock(recordFd, LOCK_UN);
+    ::close(recordFd);
+    ::close(indexFd);
+    return rebuilt;
+}
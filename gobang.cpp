@@ -1,341 +1,504 @@
 #include <iostream>
 #include <string>
 #include <cstring>
+#include <cstdlib>
 #include <algorithm>
-#include <queue>
+#include <vector>
 #include <cstdint>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <fstream>
 #include <signal.h>
-#include "jsoncpp/json.h"
+#include <unistd.h>
+#include <sys/resource.h>
 #include "gobang.h"
 #include "grid.hpp"
+#include "winJudge.h"
+#include "engineProtocol.hpp"
+#include "engineProtocolJson.hpp"
+#include "gobangEngine.h"
+#include "benchPositions.hpp"
 using namespace std;
 
-bool terminateIndicator = false;
+GobangEngineHandle engine(GOBANG_MIN_TABLE_BITS); //libgobang搜索引擎，棋盘、记忆化表与置换表都在其中；常驻模式下在init中换成完整大小的置换表
+ChessboardGrid board; //与引擎同步的棋盘副本，用于判胜；引擎搜索期间棋盘被搜索占用，判胜仍可使用副本
+GobangSearchResult lastSearch; //最近一次搜索的结果，包含主要变例中人类的预期应对
+bool exitIndicator = false; //常驻模式下收到SIGINT或SIGTERM时，答复当前请求后退出
 void signalHandler(int sig) {
 	if (sig == SIGINT || sig == SIGTERM || sig == SIGALRM)
-		terminateIndicator = true;
+		engine.stop();
+	if (sig == SIGINT || sig == SIGTERM)
+		exitIndicator = true;
 }
 
-int DEPTH; //极大极小搜索深度
-constexpr int SCORE_LENGTH = 6; //Score*数组的长度
-constexpr int SHIFT_LENGTH = 8; //*Shift数组的长度
 static bool restrictedMove = false; //是否有禁手
+static bool keepRunning = false; //常驻模式：逐行读取请求，在请求之间保留棋盘与记忆化表
+static unsigned int timeLimit = 0; //常驻模式下每步搜索的时间限制（秒），0为不限制
+static GobangSearchLimits searchLimits = {}; //每步搜索的深度、节点数与时间（毫秒）限制，设置了时间限制时代替TIMEOUT
+static bool ponderEnabled = false; //常驻模式下是否在对手思考时进行后台搜索
+static bool binaryProtocol = false; //是否使用二进制帧协议代替每行一个JSON的协议
+static const char * batchInput = NULL; //批量分析模式的输入文件，"-"为标准输入，NULL时不使用批量分析模式
+static int batchThreads = max(1u, thread::hardware_concurrency()); //批量分析的线程数
+static bool batchOrdered = false; //批量分析结果是否按输入顺序输出，否则按完成顺序输出
+static GobangSearchLimits batchLimits = {}; //批量分析时每个局面的搜索深度、节点数与时间限制
 
-int PositionNodeSortMethod = 0; //启发式评估用到的排序方式指示变量
-struct PositionNode { //使用启发式评估对搜索落子顺序进行调整，从而便于α-β剪枝的数据结构
-	int x, y; //落子坐标位置
-	long long priority; //启发式评估的评估值
-	PositionNode(int x, int y, long long priority) :x(x), y(y), priority(priority) {}
-	//评估值小的优先搜索的排序函数
-	bool cmpLess(const PositionNode& o1, const PositionNode& o2) const {
-		return o2.priority < o1.priority;
+vector<ChessPosition> appliedHistory; //已经摆放到棋盘上的落子历史，依次为requests[0], responses[0], requests[1], ...
+bool appliedHistoryValid = true; //棋盘是否恰好由appliedHistory摆放而成，增量协议修改棋盘后失效
+ChessPosition lastMove(-1, -1); //增量协议下最后一步落子的位置，未知时为(-1, -1)
+//同时在引擎和棋盘副本上落子，坐标不存在时返回false
+bool placeMove(const ChessPosition & move, ChessPiece piece) {
+	if (!engine.applyMove(move.x, move.y, piece)) return false;
+	board.set(move.x, move.y, piece);
+	return true;
+}
+//以按行排列的棋盘快照重置引擎和棋盘副本，快照为空时清空棋盘
+void setupBoard(const char * snapshot, int length) {
+	engine.setPosition(snapshot, length);
+	board = ChessboardGrid();
+	for (int i = 0; i < SIZE * SIZE && i < length; i++) {
+		if (snapshot[i] == '0' + BOT) board.set(i / SIZE, i % SIZE, BOT);
+		else if (snapshot[i] == '0' + PLAYER) board.set(i / SIZE, i % SIZE, PLAYER);
+	}
+}
+void init() {
+    char * restrictedMoveEnv = std::getenv("RESTRICTED_MOVE");
+    if (restrictedMoveEnv) restrictedMove = true;
+    char * keepRunningEnv = std::getenv("KEEP_RUNNING");
+    if (keepRunningEnv) keepRunning = true;
+    char * timeoutEnv = std::getenv("TIMEOUT");
+    if (timeoutEnv) timeLimit = std::strtoul(timeoutEnv, NULL, 10);
+    char * searchDepthEnv = std::getenv("SEARCH_DEPTH");
+    if (searchDepthEnv) searchLimits.maxDepth = std::strtol(searchDepthEnv, NULL, 10);
+    char * searchNodesEnv = std::getenv("SEARCH_NODES");
+    if (searchNodesEnv) searchLimits.nodeLimit = std::strtoull(searchNodesEnv, NULL, 10);
+    char * searchTimeEnv = std::getenv("SEARCH_TIME_MS");
+    if (searchTimeEnv) searchLimits.timeLimitMs = std::strtoul(searchTimeEnv, NULL, 10);
+    char * ponderEnv = std::getenv("PONDER");
+    if (ponderEnv && keepRunning) ponderEnabled = true;
+    char * binaryProtocolEnv = std::getenv("BINARY_PROTOCOL");
+    if (binaryProtocolEnv) binaryProtocol = true;
+    batchInput = std::getenv("BATCH");
+    char * batchThreadsEnv = std::getenv("BATCH_THREADS");
+    if (batchThreadsEnv && std::strtol(batchThreadsEnv, NULL, 10) > 0) batchThreads = std::strtol(batchThreadsEnv, NULL, 10);
+    char * batchOrderedEnv = std::getenv("BATCH_ORDERED");
+    if (batchOrderedEnv) batchOrdered = true;
+    char * batchDepthEnv = std::getenv("BATCH_DEPTH");
+    if (batchDepthEnv) batchLimits.maxDepth = std::strtol(batchDepthEnv, NULL, 10);
+    char * batchNodesEnv = std::getenv("BATCH_NODES");
+    if (batchNodesEnv) batchLimits.nodeLimit = std::strtoull(batchNodesEnv, NULL, 10);
+    char * batchTimeEnv = std::getenv("BATCH_TIME_MS");
+    if (batchTimeEnv) batchLimits.timeLimitMs = std::strtoul(batchTimeEnv, NULL, 10);
+
+	//只处理一个请求时置换表无法在各步之间复用，使用最小的表，免得每次启动都分配并清零整张表；
+	//常驻模式（包括后台搜索）保留置换表，使用完整大小。须在安装信号处理函数之前替换引擎
+	if (keepRunning) engine = GobangEngineHandle();
+	signal(SIGINT, signalHandler);
+	signal(SIGTERM, signalHandler);
+	signal(SIGALRM, signalHandler);
+}
+//请求中的落子历史依次为requests[0], responses[0], requests[1], ...
+size_t historyLength(const EngineRequest & request) {
+	return request.requestCount + request.responseCount;
+}
+ChessPosition historyAt(const EngineRequest & request, size_t i) {
+	return i % 2 == 0 ? request.requests[i / 2] : request.responses[i / 2];
+}
+bool isSamePosition(const ChessPosition & a, const ChessPosition & b) {
+	return a.x == b.x && a.y == b.y;
+}
+//判断appliedHistory是否为请求落子历史的前缀
+bool isAppliedHistoryPrefixOf(const EngineRequest & request) {
+	if (appliedHistory.size() > historyLength(request)) return false;
+	for (size_t i = 0; i < appliedHistory.size(); i++)
+		if (!isSamePosition(appliedHistory[i], historyAt(request, i))) return false;
+	return true;
+}
+//按请求中的落子历史同步棋盘
+//若请求只是在已摆放的历史之后追加了落子，则只摆放新增的落子；否则清空棋盘重新摆放
+void syncHistory(const EngineRequest & request) {
+	size_t start = 0;
+	if (appliedHistoryValid && isAppliedHistoryPrefixOf(request))
+		start = appliedHistory.size();
+	else
+		setupBoard(NULL, 0);
+	appliedHistory.resize(start);
+	//读取数据，模拟落子过程
+	for (size_t i = start; i < historyLength(request); i++) {
+		ChessPosition move = historyAt(request, i);
+		placeMove(move, i % 2 == 0 ? PLAYER : BOT);
+		appliedHistory.push_back(move);
 	}
-	//评估值大的优先搜索的排序函数
-	bool cmpGreater(const PositionNode& o1, const PositionNode& o2) const {
-		return o1.priority < o2.priority;
+	appliedHistoryValid = true;
+}
+//增量协议：
+//{"setup":{"board":"..."}}以紧凑的棋盘快照重置棋盘，快照为按行排列的SIZE*SIZE个字符，'0'为空，'1'为机器人，'2'为人类；
+//{"move":{"x":..,"y":..}}只摆放人类的一步落子。
+//两者可与"type"同时出现，先重置棋盘、再摆放落子、最后处理请求类型；type为0时机器人的答复也会直接摆放到棋盘上
+void applyIncrementalRequest(const EngineRequest & request) {
+	if (request.hasSetup) {
+		setupBoard(request.board, request.boardLength);
+		lastMove = ChessPosition(-1, -1);
 	}
-	/*
-	极大极小搜索函数根据当前搜索的层数选择使用排序方式：
-	当PositionNodeSortMethod为0时，是模拟机器人落子，此时应当优先搜索评估值大的落子方案，使得对于机器人利益最大化。
-	当PositionNodeSortMethod为1时，是模拟人类落子，此时应当优先搜索评估值小的落子方案，使得对于机器人利益最小化。
-	*/
-	bool operator <(const PositionNode& o2) const {
-		if (PositionNodeSortMethod == 0)return cmpGreater(*this, o2);
-		else return cmpLess(*this, o2);
+	//落子须在棋盘内的空位上，否则忽略，不覆盖已有的棋子
+	const ChessPosition & move = request.move;
+	if (request.hasMove && move.x >= 0 && move.x < SIZE && move.y >= 0 && move.y < SIZE && board.get(move.x, move.y) == EMPTY) {
+		if (placeMove(move, PLAYER))
+			lastMove = move;
 	}
-};
-
-struct Gobang {
-	ChessboardGrid grid; //经位图优化的二维模拟棋盘
-	bool unitDiffStorageValid[PIECE_END][SIZE][SIZE]; //记忆化的评估差分分数有效指示
-	long long unitDiffStorage[PIECE_END][SIZE][SIZE]; //记忆化的评估差分分数
-	//XShift和YShift数组是程序搜索过程中遍历指定方格的邻接方格的偏移量
-	const int XShift[SHIFT_LENGTH] = { -1, -1, -1, 0, 0, 1, 1, 1 };
-	const int YShift[SHIFT_LENGTH] = { -1, 0, 1, -1, 1, -1, 0, 1 };
-	//死棋的评估分数（有一头被堵住，另一头没有被堵住，只有一头可以继续下棋）
-	const long long Score_E1[SCORE_LENGTH] = { 0, 1, 5, 25, 1250, 1000000 };
-	//活棋的评估分数（两头没有被堵住，都可以下棋）
-	const long long Score_E2[SCORE_LENGTH] = { 0, 5, 20, 200, 1500, 1000000 };
-
-	//将类型为value的棋子落子在棋盘(x,y)坐标，成功返回true，坐标不存在返回false
-	inline bool placeAt(int x, int y, ChessPiece value, bool invalidate = false) {
-		if (x >= 0 && y >= 0 && x < SIZE && y < SIZE) {
-			if (invalidate) {
-				if (grid.get(x, y) != value) invalidateUnitDiff(x, y);
-			}
-			grid.set(x, y, value);
-			return true;
-		}
-		return false;
+	appliedHistory.clear();
+	appliedHistoryValid = false;
+}
+//对手思考时的后台搜索：答复之后假设人类按主要变例应对，在后台线程中提前搜索下一步
+//命中时继续这次搜索并采用其结果，未命中时中止搜索并撤销预期应对
+struct Ponder {
+	future<GobangSearchResult> search; //后台搜索线程的结果
+	bool active = false; //后台搜索已开始且尚未回收
+	bool incremental = false; //开始后台搜索时使用的协议
+	bool moveConsumed = false; //增量协议下预期应对已被请求确认（例如先收到携带该落子的判胜请求）
+	ChessPosition predictedMove; //人类的预期应对
+} ponder;
+void startPondering(bool incremental, const ChessPosition & ownMove) {
+	if (!ponderEnabled || !lastSearch.hasExpectedReply) return;
+	ponder.predictedMove = ChessPosition(lastSearch.expectedReply.x, lastSearch.expectedReply.y);
+	if (!incremental) { //全量协议下机器人的答复还未摆放到棋盘上
+		placeMove(ownMove, BOT);
+		appliedHistory.push_back(ownMove);
+		appliedHistory.push_back(ponder.predictedMove);
+	}
+	placeMove(ponder.predictedMove, PLAYER);
+	ponder.incremental = incremental;
+	ponder.moveConsumed = false;
+	ponder.active = true;
+	//后台搜索与正常搜索使用相同的深度与节点数限制，但不限时，由命中或未命中的请求中止
+	GobangSearchLimits limits = searchLimits;
+	limits.timeLimitMs = 0;
+	ponder.search = async(launch::async, [limits] {
+		GobangSearchResult result;
+		engine.search(result, limits); //searchLimits已在启动时检查
+		return result;
+	});
+}
+//中止后台搜索并取得结果；搜索开始时会清除之前的中止请求，因此重复发出直到搜索线程结束
+GobangSearchResult finishPonderSearch() {
+	do engine.stop(); while (ponder.search.wait_for(chrono::milliseconds(1)) != future_status::ready);
+	ponder.active = false;
+	return ponder.search.get();
+}
+void stopPondering() {
+	finishPonderSearch();
+	if (ponder.moveConsumed) return;
+	placeMove(ponder.predictedMove, EMPTY);
+	if (!ponder.incremental) appliedHistory.pop_back();
+}
+//判断请求是否与后台搜索预期的局面一致
+bool isPonderHit(const EngineRequest & request, bool incremental) {
+	if (incremental != ponder.incremental) return false;
+	if (incremental) {
+		if (request.hasSetup) return false;
+		if (!request.hasMove) return ponder.moveConsumed;
+		return !ponder.moveConsumed && isSamePosition(request.move, ponder.predictedMove);
 	}
-	//获得棋盘上(x,y)坐标位置的棋子类型，若坐标不存在返回NOT_EXIST
-	inline ChessPiece getValueAt(int x, int y) {
-		if (x >= 0 && y >= 0 && x < SIZE && y < SIZE)
-			return grid.get(x, y);
-		else
-			return NOT_EXIST;
+	return historyLength(request) == appliedHistory.size() && isAppliedHistoryPrefixOf(request);
+}
+EngineResponse judgeResponse(ChessPiece finishedChess) {
+	EngineResponse ret;
+	ret.winner = finishedChess;
+	if (finishedChess != EMPTY) ret.prompt = getWinPrompt(finishedChess);
+	return ret;
+}
+EngineResponse moveResponse(const ChessPosition & move) {
+	EngineResponse ret;
+	ret.kind = EngineResponseKind::MOVE;
+	ret.move = move;
+	return ret;
+}
+//机器人给出答复之后：增量协议下把答复摆放到棋盘上，然后开始后台搜索
+void afterResponse(const ChessPosition & ownMove, bool incremental) {
+	if (incremental) {
+		lastMove = ownMove;
+		placeMove(lastMove, BOT);
 	}
-	//传入棋子类型status，连续棋子数cnt，两边有几边是空的edgeSituation，获取当前连续棋子的评估分数
-	inline long long getScore(ChessPiece status, int cnt, int edgeSituation) {
-		//当两边都被堵住时，如果在中间下棋有可能成五，需要返回一个评估值，解决了不堵中间的Bug
-		if (edgeSituation == 0) {
-			switch (status) {
-			case BOT:
-				return cnt == 5 ? Score_E2[5] : 0;
-			case PLAYER:
-				return -(cnt == 5 ? Score_E2[5] : 0);
-			default:
-				return 0;
+	startPondering(incremental, ownMove);
+}
+//每步搜索的时间限制（毫秒），0为不限制；非常驻模式下TIMEOUT由闹钟信号实现
+unsigned int moveTimeLimitMs() {
+	if (searchLimits.timeLimitMs) return searchLimits.timeLimitMs;
+	return keepRunning ? timeLimit * 1000 : 0;
+}
+EngineResponse handleRequest(const EngineRequest & request) {
+	bool incremental = !request.hasHistory;
+	int requestType = request.type;
+	EngineResponse ret;
+	if (ponder.active) {
+		if (!isPonderHit(request, incremental)) {
+			stopPondering();
+		} else {
+			if (incremental) {
+				ponder.moveConsumed = true;
+				lastMove = ponder.predictedMove;
 			}
+			if (requestType == 1) // 后台搜索继续进行，在棋盘副本上判胜
+				return judgeResponse(judgeWinsOnBoard(board));
+			//命中：后台搜索在本步的时间限制内继续进行，然后采用其结果；
+			//不限时则等待它在深度与节点数限制内结束，与正常搜索这一步的耗时相同
+			if (moveTimeLimitMs()) ponder.search.wait_for(chrono::milliseconds(moveTimeLimitMs()));
+			else ponder.search.wait();
+			lastSearch = finishPonderSearch();
+			ChessPosition ownMove(lastSearch.move.x, lastSearch.move.y);
+			afterResponse(ownMove, incremental);
+			return moveResponse(ownMove);
 		}
-		//两边有一边为空或两边都为空时，到Score_E1和Score_E2数组中去查找对应的棋子评估分数并返回
-		else if (edgeSituation == 1) {
-			switch (status) {
-			case BOT:
-				return cnt >= SCORE_LENGTH ? Score_E1[SCORE_LENGTH - 1] : Score_E1[cnt];
-			case PLAYER:
-				return -(cnt >= SCORE_LENGTH ? Score_E1[SCORE_LENGTH - 1] : Score_E1[cnt]);
-			default:
-				return 0;
-			}
+	}
+	if (incremental) applyIncrementalRequest(request);
+	else syncHistory(request);
+	switch (requestType) {
+		case 0: // Minimax Search
+		{
+			GobangSearchLimits limits = searchLimits;
+			limits.timeLimitMs = moveTimeLimitMs();
+			engine.search(lastSearch, limits); //searchLimits已在启动时检查
+			ChessPosition ownMove(lastSearch.move.x, lastSearch.move.y);
+			afterResponse(ownMove, incremental);
+			ret = moveResponse(ownMove);
+			break;
 		}
-		else { // edgeSituation==2
-			switch (status) {
-			case BOT:
-				return cnt >= SCORE_LENGTH ? Score_E2[SCORE_LENGTH - 1] : Score_E2[cnt];
-			case PLAYER:
-				return -(cnt >= SCORE_LENGTH ? Score_E2[SCORE_LENGTH - 1] : Score_E2[cnt]);
-			default:
-				return 0;
-			}
+		case 1: // Judge Finished
+		{
+			ret = judgeResponse(incremental && lastMove.x >= 0 ? judgeWinsAt(board, lastMove.x, lastMove.y) : judgeWinsOnBoard(board));
+			break;
 		}
 	}
-	//传入两边的棋子状态，计算两边为空的位置格数
-	inline int calculateEdgeSituation(ChessPiece leftEdgeStatus, ChessPiece rightEdgeStatus) {
-		int cnt = 0;
-		if (EMPTY == leftEdgeStatus)
-			cnt++;
-		if (EMPTY == rightEdgeStatus)
-			cnt++;
-		return cnt;
+	return ret;
+}
+//二进制协议：读取一个请求帧，输入结束时返回false；帧格式见engineProtocol.hpp
+bool readBinaryRequest(EngineRequest & request) {
+	uint8_t header[BINARY_HEADER_SIZE], payload[BINARY_MAX_FRAME_SIZE];
+	if (!cin.read((char *) header, BINARY_HEADER_SIZE)) return false;
+	int length = readBinaryPayloadLength(header);
+	if (length > BINARY_MAX_FRAME_SIZE - BINARY_HEADER_SIZE || !cin.read((char *) payload, length)) return false;
+	//格式错误的帧按空请求处理，与无法解析的JSON请求一致
+	if (!decodeBinaryEngineRequest(header, payload, request)) {
+		request.clear();
+		request.type = header[2];
 	}
-	//计算ChessboardLine line所指定的连成一条线上的棋子的评估分数
-	long long SequenceEvaluate(ChessboardLine &line, ChessPiece * isFinished = NULL) {
-		long long sum = 0;
-
-		auto lambda = [&] (ChessPiece currentPiece, int count, int position, ChessPiece leftOutOfBoundPiece, ChessPiece rightOutOfBoundPiece) {
-			sum += getScore(currentPiece, count, calculateEdgeSituation(rightOutOfBoundPiece, leftOutOfBoundPiece));
-			if (isFinished && currentPiece != EMPTY && count >= 5) *isFinished = currentPiece;
-		};
-
-		grid.lambdaForTraverseChessboardLine(line, lambda);
-		return sum;
+	return true;
+}
+//批量分析模式：每行请求是一个独立的局面，由batchThreads个线程各用一个引擎并行分析，每行输出一个JSON结果
+struct BatchJob {
+	size_t index; //输入中第几个非空行，从0开始
+	string line;
+};
+struct BatchQueue {
+	mutex lock;
+	condition_variable changed;
+	deque<BatchJob> jobs;
+	map<size_t, string> finished; //按顺序输出时，等待前面的局面完成的结果
+	size_t nextOutput = 0; //按顺序输出时下一个要输出的下标
+	size_t inFlight = 0; //已读入但尚未输出的局面数，限制读入的进度以免结果堆积
+	bool inputEnded = false;
+} batch;
+//按请求摆放一个独立的局面：全量协议摆放落子历史，增量协议摆放快照与人类的落子；lastMove为最后一步已知的落子
+ChessboardGrid buildBatchBoard(const EngineRequest & request, ChessPosition & lastMove) {
+	ChessboardGrid grid;
+	lastMove = ChessPosition(-1, -1);
+	auto place = [&](const ChessPosition & move, ChessPiece piece) {
+		if (move.x < 0 || move.y < 0 || move.x >= SIZE || move.y >= SIZE) return;
+		grid.set(move.x, move.y, piece);
+		lastMove = move;
+	};
+	if (request.hasHistory) {
+		for (size_t i = 0; i < historyLength(request); i++)
+			place(historyAt(request, i), i % 2 == 0 ? PLAYER : BOT);
+		lastMove = ChessPosition(-1, -1); //与常驻模式一致，全量协议在整个棋盘上判胜
+		return grid;
 	}
-	//评估坐标(x,y)处所对应的分数
-	long long EvaluateUnit(int x, int y, ChessPiece * isFinished = NULL) {
-		long long sum = 0;
-		constexpr int ChessboardLineCount = 4;
-		ChessboardLine ChessboardLineArr[ChessboardLineCount] = {
-			ChessboardLine(ChessboardLineType::LINE, x, 0), // 行
-			ChessboardLine(ChessboardLineType::ROW, 0, y), // 列
-			ChessboardLine(ChessboardLineType::ULLRDiagonal, x, y), // 左上-右下对角线
-			ChessboardLine(ChessboardLineType::LLURDiagonal, x, y) // 右上-左下对角线
-		};
-		for (int k = 0; k < ChessboardLineCount; k++) {
-			sum += SequenceEvaluate(ChessboardLineArr[k], isFinished);
-		}
-		return sum;
+	for (int i = 0; request.hasSetup && i < request.boardLength; i++) {
+		if (request.board[i] == '0' + BOT) grid.set(i / SIZE, i % SIZE, BOT);
+		else if (request.board[i] == '0' + PLAYER) grid.set(i / SIZE, i % SIZE, PLAYER);
 	}
-	// 差分地使记忆化评估差分分数无效
-	void invalidateUnitDiff(int x, int y) {
-		constexpr int ChessboardLineCount = 4;
-		ChessboardLine ChessboardLineArr[ChessboardLineCount] = {
-			ChessboardLine(ChessboardLineType::LINE, x, 0), // 行
-			ChessboardLine(ChessboardLineType::ROW, 0, y), // 列
-			ChessboardLine(ChessboardLineType::ULLRDiagonal, x, y), // 左上-右下对角线
-			ChessboardLine(ChessboardLineType::LLURDiagonal, x, y) // 右上-左下对角线
-		};
-		for (int k = 0; k < ChessboardLineCount; k++) {
-			for (int i = 0; i < ChessboardLineArr[k].size(); i++) {
-				unitDiffStorageValid[BOT - PIECE_START][ChessboardLineArr[k].i(i)][ChessboardLineArr[k].j(i)] = false;
-				unitDiffStorageValid[PLAYER - PIECE_START][ChessboardLineArr[k].i(i)][ChessboardLineArr[k].j(i)] = false;
+	if (request.hasMove) place(request.move, PLAYER);
+	return grid;
+}
+//分析一行请求，返回以换行结尾的JSON结果：type为0时为落子、分数、完成的深度、节点数与用时，type为1时为判胜结果
+string analyseBatchLine(GobangEngineHandle & batchEngine, EngineRequest & request, const BatchJob & job) {
+	auto start = chrono::steady_clock::now();
+	parseEngineRequestLine(job.line.data(), job.line.size(), request);
+	ChessPosition last;
+	ChessboardGrid grid = buildBatchBoard(request, last);
+	char buffer[256];
+	if (request.type == 1) {
+		ChessPiece winner = last.x >= 0 ? judgeWinsAt(grid, last.x, last.y) : judgeWinsOnBoard(grid);
+		snprintf(buffer, sizeof(buffer), "{\"index\":%zu,\"winner\":%d}\n", job.index, (int) winner);
+		return buffer;
+	}
+	char snapshot[SIZE * SIZE];
+	for (int i = 0; i < SIZE * SIZE; i++)
+		snapshot[i] = '0' + grid.get(i / SIZE, i % SIZE);
+	//每个局面都从新引擎的状态开始分析，结果与线程数及分配到哪个线程无关
+	batchEngine.setPosition(snapshot, SIZE * SIZE);
+	batchEngine.clear();
+	GobangSearchResult result;
+	batchEngine.search(result, batchLimits); //batchLimits已在启动时检查
+	double timeMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+	snprintf(buffer, sizeof(buffer), "{\"index\":%zu,\"x\":%d,\"y\":%d,\"score\":%lld,\"depth\":%d,\"nodes\":%llu,\"timeMs\":%.3f}\n",
+		job.index, result.move.x, result.move.y, result.score, result.completedDepth, result.nodes, timeMs);
+	return buffer;
+}
+void batchWorker() {
+	GobangEngineHandle batchEngine;
+	EngineRequest request;
+	while (true) {
+		BatchJob job;
+		{
+			unique_lock<mutex> guard(batch.lock);
+			batch.changed.wait(guard, [] { return !batch.jobs.empty() || batch.inputEnded; });
+			if (batch.jobs.empty()) return;
+			job = move(batch.jobs.front());
+			batch.jobs.pop_front();
+		}
+		string output = analyseBatchLine(batchEngine, request, job);
+		lock_guard<mutex> guard(batch.lock);
+		if (!batchOrdered) {
+			cout << output;
+			batch.inFlight--;
+		} else {
+			batch.finished.emplace(job.index, move(output));
+			for (auto it = batch.finished.begin(); it != batch.finished.end() && it->first == batch.nextOutput; it = batch.finished.erase(it)) {
+				cout << it->second;
+				batch.nextOutput++;
+				batch.inFlight--;
 			}
 		}
+		batch.changed.notify_all();
 	}
-	//评估在坐标(x,y)处落子时，对总评估分数会产生的差值，这样可以加快搜索速度
-	//落子种类由搜索深度决定
-	long long EvaluateUnitDiff(ChessPiece piece, int x, int y) {
-		if (unitDiffStorageValid[piece - PIECE_START][x][y])
-			return unitDiffStorage[piece - PIECE_START][x][y];
-		placeAt(x, y, EMPTY);
-		long long sum1 = EvaluateUnit(x, y);
-		placeAt(x, y, piece);
-		long long sum2 = EvaluateUnit(x, y);
-		placeAt(x, y, EMPTY);
-		unitDiffStorageValid[piece - PIECE_START][x][y] = true;
-		return unitDiffStorage[piece - PIECE_START][x][y] = sum2 - sum1;
+}
+//逐行读取输入并分发给工作线程；收到SIGINT或SIGTERM时停止读取，已读入的局面仍会分析完
+int runBatch() {
+	if (!isGobangSearchLimitsValid(&batchLimits)) {
+		fprintf(stderr, "BATCH_DEPTH must be an even depth the engine supports\n");
+		return 1;
 	}
-	//极大极小搜索与α-β剪枝搜索函数
-	//参数为当前搜索深度depth，返回的落子位置数据结构movePos，α值alpha，β值beta，棋局评估分数evaluationValue
-	long long minimaxSearch(int depth, ChessPosition* movePos, long long alpha, long long beta, long long evaluationValue) {
-		//depth%2==0时为BOT，depth%2==1时为PLAYER
-		if (depth == DEPTH) //到达边界深度时，结束搜索，直接返回棋局评估分数
-			return evaluationValue;
-		long long selectedScore = depth % 2 == 0 ? alpha : beta; //根据是极大层还是极小层决定剪枝的边界分数是α还是β
-		PositionNodeSortMethod = depth % 2; //根据搜索层数选择启发式评估的排序方式
-		priority_queue<PositionNode> pq; //使用优先队列对启发式评估的落子位置排序
-		//循环遍历整个棋盘，寻找可以落子的位置
-		for (int i = 0; i < SIZE; i++) {
-			for (int j = 0; j < SIZE; j++) {
-				if (getValueAt(i, j) != EMPTY) //当前格子不为空时，不能落子，跳过
-					continue;
-				bool flag = false;
-				for (int k = 0; k < SHIFT_LENGTH; k++) {
-					//当前格子周围邻接的格子如果有子，就把它当成一个可能的落子位置并加以评估
-					int value = getValueAt(i + XShift[k], j + YShift[k]);
-					if (value == PLAYER || value == BOT) {
-						flag = true;
-						break;
-					}
-				}
-				if (flag) //启发式评估成功之后加入优先队列进行排序
-					pq.emplace(i, j, EvaluateUnitDiff(depth % 2 == 0 ? BOT : PLAYER, i, j));
-			}
-		}
-		if (depth == 0) { //若深度为0的话，首先选择启发式评估值最大的落子情况初始化返回的落子位置
-			PositionNode curPositionNode = pq.top();
-			int i = curPositionNode.x, j = curPositionNode.y;
-			movePos->x = i;
-			movePos->y = j;
-		}
-		while (!pq.empty()) { //当优先队列非空时，取出评估落子情况用的数据结构并准备向下搜索
-			PositionNode curPositionNode = pq.top();
-			pq.pop();
-			int i = curPositionNode.x, j = curPositionNode.y;
-			placeAt(i, j, depth % 2 == 0 ? BOT : PLAYER, true); //根据搜索层数选择落子类型是机器人还是人类
-			long long curScore;
-			if (depth % 2 == 0) { // 极大层节点时，继续搜索极小层节点
-				curScore = minimaxSearch(depth + 1, NULL, selectedScore, beta, evaluationValue + curPositionNode.priority);
-			}
-			else { // 极小层节点时，继续搜索极大层节点
-				curScore = minimaxSearch(depth + 1, NULL, alpha, selectedScore, evaluationValue + curPositionNode.priority);
-			}
-			if (depth % 2 == 0) { //极大层节点，取最大的棋局评估值更新α值
-				if (selectedScore < curScore) {
-					selectedScore = curScore;
-					if (depth == 0) { //当搜索深度为0时，更新返回的落子位置
-						movePos->x = i;
-						movePos->y = j;
-					}
-				}
-			}
-			else { //极小层节点，取最小的棋局评估值更新β值
-				if (selectedScore > curScore) {
-					selectedScore = curScore;
-				}
-			}
-			placeAt(i, j, EMPTY, true); //回溯
-			//α-β剪枝
-			if (depth % 2 == 0) { //极大层进行β剪枝
-				if (selectedScore >= beta)
-					return beta;
-			}
-			else { //极小层进行α剪枝
-				if (selectedScore <= alpha)
-					return alpha;
-			}
-			if (terminateIndicator) break;
+	ifstream file;
+	if (strcmp(batchInput, "-") != 0) {
+		file.open(batchInput);
+		if (!file) {
+			perror(batchInput);
+			return 1;
 		}
-		return selectedScore; //如果没有剪枝，返回最终的棋局评估结果
 	}
-	//选择落子位置的函数
-	inline Json::Value ChoosePosition(int cnter)
+	istream & input = file.is_open() ? file : cin;
+	vector<thread> workers;
+	for (int i = 0; i < batchThreads; i++)
+		workers.emplace_back(batchWorker);
+	string line;
+	size_t index = 0;
+	const size_t window = batchThreads * 16;
+	while (!exitIndicator && getline(input, line)) {
+		if (line.empty()) continue;
+		unique_lock<mutex> guard(batch.lock);
+		batch.changed.wait(guard, [&] { return batch.inFlight < window; });
+		batch.jobs.push_back({ index++, move(line) });
+		batch.inFlight++;
+		batch.changed.notify_all();
+	}
 	{
-		ChessPosition move;
-		Json::Value action;
-		memset(unitDiffStorageValid, false, sizeof(unitDiffStorageValid));
-		if (cnter != 0) { //机器人后手的情况
-			long long evaluationValue = INT64_MIN;
-			for (DEPTH = 4; DEPTH <= 10; DEPTH += 2) { //分别搜索4~10层的情况，取最优解，如果超时可中途退出
-				long long tmpEvaluationValue = minimaxSearch(0, &move, INT64_MIN, INT64_MAX, 0);
-				if (tmpEvaluationValue > evaluationValue) {
-					action["x"] = move.x;
-					action["y"] = move.y;
-					evaluationValue = tmpEvaluationValue;
-				}
-			}
-		}
-		else { //机器人先手落子在棋盘中心
-			action["x"] = 7;
-			action["y"] = 7;
-		}
-		return action;
+		lock_guard<mutex> guard(batch.lock);
+		batch.inputEnded = true;
 	}
-	ChessPiece judgeFinished() {
-		ChessPiece isFinished = EMPTY;
-		for (int i = 0; i < SIZE; i++) {
-			for (int j = 0; j < SIZE; j++) {
-				EvaluateUnit(i, j, &isFinished);
-			}
-		}
-		return isFinished;
+	batch.changed.notify_all();
+	for (thread & worker : workers) worker.join();
+	cout << flush;
+	return 0;
+}
+//基准测试：在固定的局面集（benchPositions.hpp）上以固定深度或节点数逐个搜索
+//节点总数作为签名，搜索行为的任何变化都会改变它；每秒节点数用于比较不同提交与机器的速度
+//用法：gobang bench [depth 深度 | nodes 节点数]，默认深度BENCH_DEFAULT_DEPTH
+constexpr int BENCH_DEFAULT_DEPTH = 6;
+int runBench(int argc, char ** argv) {
+	GobangSearchLimits limits = {};
+	limits.maxDepth = BENCH_DEFAULT_DEPTH;
+	if (argc == 2 && strcmp(argv[0], "depth") == 0) limits.maxDepth = strtol(argv[1], NULL, 10);
+	else if (argc == 2 && strcmp(argv[0], "nodes") == 0) {
+		limits.maxDepth = 0;
+		limits.nodeLimit = strtoull(argv[1], NULL, 10);
+	} else if (argc != 0) {
+		fprintf(stderr, "usage: gobang bench [depth <depth> | nodes <nodes>]\n");
+		return 2;
 	}
-	Gobang() {}
-};
-
-Gobang grid;
-void init() {
-	signal(SIGINT, signalHandler);
-	signal(SIGTERM, signalHandler);
-	signal(SIGALRM, signalHandler);
-
-    char * restrictedMoveEnv = std::getenv("RESTRICTED_MOVE");
-    if (restrictedMoveEnv) restrictedMove = true;
+	if (!isGobangSearchLimitsValid(&limits) || (!limits.maxDepth && !limits.nodeLimit)) {
+		fprintf(stderr, "bench needs an even depth the engine supports or a positive node count\n");
+		return 1;
+	}
+	GobangEngineHandle benchEngine;
+	unsigned long long totalNodes = 0;
+	double totalMs = 0;
+	int count = sizeof(benchPositions) / sizeof(benchPositions[0]);
+	for (int i = 0; i < count; i++) {
+		//按落子顺序摆放，下一步由机器人走，即与第ply步同色的棋子为机器人
+		char snapshot[SIZE * SIZE];
+		memset(snapshot, '0', sizeof(snapshot));
+		vector<int> cells;
+		int x, y, consumed;
+		for (const char * cursor = benchPositions[i].moves; sscanf(cursor, " %d,%d%n", &x, &y, &consumed) == 2; cursor += consumed)
+			cells.push_back(x * SIZE + y);
+		for (size_t k = 0; k < cells.size(); k++)
+			snapshot[cells[k]] = (cells.size() - k) % 2 == 0 ? '0' + BOT : '0' + PLAYER;
+		//每个局面都从新引擎的状态开始，节点数与运行顺序无关
+		benchEngine.setPosition(snapshot, SIZE * SIZE);
+		benchEngine.clear();
+		auto start = chrono::steady_clock::now();
+		GobangSearchResult result;
+		benchEngine.search(result, limits);
+		double timeMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+		totalNodes += result.nodes;
+		totalMs += timeMs;
+		printf("%2d/%d %-12s move %2d,%-2d score %12lld depth %2d nodes %10llu time %9.3fms\n", i + 1, count, benchPositions[i].name,
+			result.move.x, result.move.y, result.score, result.completedDepth, result.nodes, timeMs);
+	}
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	printf("\n");
+	if (limits.nodeLimit) printf("Limit: %llu nodes\n", limits.nodeLimit);
+	else printf("Limit: depth %d\n", limits.maxDepth);
+	printf("Positions: %d\n", count);
+	printf("Nodes (signature): %llu\n", totalNodes);
+	printf("Nodes/second: %.0f\n", totalMs > 0 ? totalNodes / (totalMs / 1000) : 0.0);
+	printf("Time: %.3fms total, %.3fms per position\n", totalMs, totalMs / count);
+	printf("Peak memory: %ld KB\n", usage.ru_maxrss);
+	return 0;
 }
-int main() {
+int main(int argc, char ** argv) {
+	if (argc > 1 && strcmp(argv[1], "bench") == 0) return runBench(argc - 2, argv + 2);
 	init();
+	if (batchInput) return runBatch();
+	if (!isGobangSearchLimitsValid(&searchLimits)) {
+		fprintf(stderr, "SEARCH_DEPTH must be an even depth the engine supports\n");
+		return 1;
+	}
 
 	string str;
-	getline(cin, str);
-	Json::Reader reader;
-	Json::Value input;
-	reader.parse(str, input);
-	int turnID = input["responses"].size();
-	int cnter = 0;
-	//读取数据，模拟落子过程
-	for (int i = 0; i < turnID; i++) {
-		if (grid.placeAt(input["requests"][i]["x"].asInt(), input["requests"][i]["y"].asInt(), PLAYER))
-			cnter++;
-		grid.placeAt(input["responses"][i]["x"].asInt(), input["responses"][i]["y"].asInt(), BOT);
-	}
-	if (grid.placeAt(input["requests"][turnID]["x"].asInt(), input["requests"][turnID]["y"].asInt(), PLAYER))
-		cnter++;
-	Json::Value ret;
-	int requestType = input["type"].asInt();
-	switch (requestType) {
-		case 0: // Minimax Search
-		{
-			ret["response"] = grid.ChoosePosition(cnter);
-			break;
-		}
-		case 1: // Judge Finished
-		{
-			ChessPiece finishedChess = grid.judgeFinished();
-			if (finishedChess == EMPTY) {
-				ret["status"] = 0;
-			} else {
-				ret["status"] = 1;
-				if (finishedChess == PLAYER)
-					ret["prompt"] = "Player wins!";
-				else if (finishedChess == BOT)
-					ret["prompt"] = "Bot wins!";
-				else
-					ret["prompt"] = "Unknown error: wins";
-			}
-			break;
+	EngineRequest request;
+	char responseBuffer[256];
+	//常驻模式下每行（或每帧）一个请求，直到输入结束；否则只处理一个请求
+	while (true) {
+		int length;
+		if (binaryProtocol) {
+			if (!readBinaryRequest(request)) break;
+			length = encodeBinaryEngineResponse(handleRequest(request), (uint8_t *) responseBuffer);
+		} else {
+			if (!getline(cin, str)) break;
+			//专用解析器直接解码出落子，不认识的请求交给jsoncpp
+			parseEngineRequestLine(str.data(), str.size(), request);
+			length = writeEngineResponse(handleRequest(request), responseBuffer, sizeof(responseBuffer)); // 答复以换行结尾
 		}
+		cout.write(responseBuffer, length) << flush;
+		if (!keepRunning || exitIndicator) break;
 	}
-	Json::FastWriter writer;
-	cout << writer.write(ret) << endl;
+	if (ponder.active) stopPondering();
 	return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,88 @@
+#include <new>
+#include "gobangEngine.h"
+#include "gobangSearch.hpp"
+
+struct GobangEngine {
+    Gobang gobang;
+    explicit GobangEngine(int tableBits = TRANSPOSITION_TABLE_BITS): gobang(tableBits) {}
+};
+
+GobangEngine * createGobangEngine(void) {
+    return new (std::nothrow) GobangEngine();
+}
+
+GobangEngine * createGobangEngineWithTableBits(int tableBits) {
+    if (tableBits < GOBANG_MIN_TABLE_BITS || tableBits > GOBANG_MAX_TABLE_BITS) return nullptr;
+    return new (std::nothrow) GobangEngine(tableBits);
+}
+
+void destroyGobangEngine(GobangEngine * engine) {
+    delete engine;
+}
+
+void setGobangEnginePosition(GobangEngine * engine, const char * board, int length) {
+    Gobang & gobang = engine->gobang;
+    gobang.abandonChoosePosition();
+    gobang.reset();
+    for (int i = 0; i < SIZE * SIZE && i < length; i++) {
+        if (board[i] == '0' + BOT) gobang.placeAt(i / SIZE, i % SIZE, BOT);
+        else if (board[i] == '0' + PLAYER) gobang.placeAt(i / SIZE, i % SIZE, PLAYER);
+    }
+}
+
+void clearGobangEngine(GobangEngine * engine) {
+    engine->gobang.abandonChoosePosition();
+    engine->gobang.clearSearchHistory();
+}
+
+int applyGobangEngineMove(GobangEngine * engine, int x, int y, int piece) {
+    if (piece != EMPTY && piece != BOT && piece != PLAYER) return 0;
+    engine->gobang.abandonChoosePosition();
+    return engine->gobang.placeAt(x, y, static_cast<ChessPiece>(piece));
+}
+
+int isGobangSearchLimitsValid(const GobangSearchLimits * limits) {
+    // Even depths end on a player move, as the iterative deepening does
+    int maxDepth = limits->maxDepth ? limits->maxDepth : MAX_DEPTH;
+    return maxDepth >= 2 && maxDepth <= MAX_DEPTH && maxDepth % 2 == 0;
+}
+
+int beginGobangEngineSearch(GobangEngine * engine, const GobangSearchLimits * limits) {
+    if (!isGobangSearchLimitsValid(limits)) return 0;
+    Gobang & gobang = engine->gobang;
+    int maxDepth = limits->maxDepth ? limits->maxDepth : MAX_DEPTH;
+
+    gobang.abandonChoosePosition();
+    gobang.terminateIndicator = false;
+    gobang.searchedNodes = 0;
+    gobang.nodeLimit = limits->nodeLimit;
+    gobang.hasDeadline = limits->timeLimitMs != 0;
+    gobang.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(limits->timeLimitMs);
+    gobang.beginChoosePosition(maxDepth);
+    return 1;
+}
+
+int continueGobangEngineSearch(GobangEngine * engine, unsigned long long nodeBudget, GobangSearchResult * result) {
+    Gobang & gobang = engine->gobang;
+    bool finished = gobang.continueChoosePosition(nodeBudget);
+    result->move = { gobang.chosenPosition.x, gobang.chosenPosition.y };
+    result->completedDepth = gobang.lastCompletedDepth;
+    result->nodes = gobang.searchedNodes;
+    result->hasExpectedReply = gobang.hasExpectedReply;
+    result->expectedReply = { gobang.expectedReply.x, gobang.expectedReply.y };
+    result->score = gobang.bestEvaluationValue == INT64_MIN ? 0 : gobang.bestEvaluationValue;
+    return finished;
+}
+
+void abandonGobangEngineSearch(GobangEngine * engine) {
+    engine->gobang.abandonChoosePosition();
+}
+
+int searchGobangEngine(GobangEngine * engine, const GobangSearchLimits * limits, GobangSearchResult * result) {
+    if (!beginGobangEngineSearch(engine, limits)) return 0;
+    return continueGobangEngineSearch(engine, UINT64_MAX, result);
+}
+
+void stopGobangEngine(GobangEngine * engine) {
+    engine->gobang.terminateIndicator = true;
+}
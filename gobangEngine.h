@@ -0,0 +1,142 @@
+#pragma once
+
+#ifdef __cplusplus
+#define GOBANG_API extern "C"
+#else
+#define GOBANG_API
+#endif
+
+/*
+    libgobang: the minimax search behind the gobang executable as a reentrant library.
+
+    Every engine owns its board, memo tables, transposition table and history heuristic, so any
+    number of engines can search concurrently in one process. One engine must not be used from
+    two threads at once, except for stopGobangEngine, which may be called from any thread or a
+    signal handler while a search runs.
+
+    Pieces use the ChessPiece values: 0 empty, 1 bot, 2 player. The engine always searches for
+    the bot. Boards are SIZE * SIZE characters row by row, '0' empty, '1' bot, '2' player.
+*/
+
+typedef struct GobangEngine GobangEngine;
+
+#define GOBANG_MIN_TABLE_BITS 10
+#define GOBANG_MAX_TABLE_BITS 26
+
+typedef struct GobangMove {
+    int x, y;
+} GobangMove;
+
+// Zero fields mean no limit (maxDepth: the engine's maximum depth). The node limit is checked on
+// every node: a search stops at most maxDepth nodes past it, finishing the path down to the leaf it
+// is on. The time limit is checked every 1024 nodes.
+typedef struct GobangSearchLimits {
+    int maxDepth;
+    unsigned int timeLimitMs;
+    unsigned long long nodeLimit;
+} GobangSearchLimits;
+
+typedef struct GobangSearchResult {
+    GobangMove move;
+    int completedDepth; // Deepest iteration that finished within the limits
+    unsigned long long nodes;
+    int hasExpectedReply; // Principal variation continues with a player reply
+    GobangMove expectedReply;
+    long long score; // Minimax score of the move for the bot, 0 when there was nothing to search
+} GobangSearchResult;
+
+GOBANG_API GobangEngine * createGobangEngine(void);
+// Engine with a transposition table of 2^tableBits entries (GOBANG_MIN_TABLE_BITS to GOBANG_MAX_TABLE_BITS)
+// instead of the default 2^20, for processes that keep many engines; NULL when out of range
+GOBANG_API GobangEngine * createGobangEngineWithTableBits(int tableBits);
+GOBANG_API void destroyGobangEngine(GobangEngine * engine);
+// Whether a search accepts the limits: maxDepth must be 0 or an even depth the engine supports
+GOBANG_API int isGobangSearchLimitsValid(const GobangSearchLimits * limits);
+
+// Clear the board, then place the pieces of a board string (shorter strings leave the rest empty)
+GOBANG_API void setGobangEnginePosition(GobangEngine * engine, const char * board, int length);
+// Forget what earlier searches learned (transposition table, history heuristic), so the next search
+// behaves as on a newly created engine; the board is kept
+GOBANG_API void clearGobangEngine(GobangEngine * engine);
+// Place (or with piece 0 remove) one piece; returns 0 for a position off the board
+GOBANG_API int applyGobangEngineMove(GobangEngine * engine, int x, int y, int piece);
+// Choose the bot's move on the current board, which is left unchanged; returns 0 on invalid limits
+GOBANG_API int searchGobangEngine(GobangEngine * engine, const GobangSearchLimits * limits, GobangSearchResult * result);
+/*
+    Resumable search, for scheduling many searches on few threads: beginGobangEngineSearch starts
+    choosing a move under the given limits, then every continueGobangEngineSearch call searches at
+    most nodeBudget more nodes and returns 1 once the search has finished, 0 when it yielded. The
+    result is filled either way, with the best move of the iterations completed so far. Until the
+    search finishes the board holds the search's own moves; abandonGobangEngineSearch, or setting
+    the position or applying a move, drops an unfinished search and restores the board first.
+    searchGobangEngine is a begin followed by one continue without a budget.
+*/
+GOBANG_API int beginGobangEngineSearch(GobangEngine * engine, const GobangSearchLimits * limits);
+GOBANG_API int continueGobangEngineSearch(GobangEngine * engine, unsigned long long nodeBudget, GobangSearchResult * result);
+GOBANG_API void abandonGobangEngineSearch(GobangEngine * engine);
+// Make the running search return its best move so far; a search clears earlier stop requests when it starts
+GOBANG_API void stopGobangEngine(GobangEngine * engine);
+
+#ifdef __cplusplus
+
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+// Owning C++ interface over the C API; the constructors throw instead of holding a NULL engine
+class GobangEngineHandle {
+    GobangEngine * engine;
+    static GobangEngine * checked(GobangEngine * created) {
+        if (!created) throw std::bad_alloc();
+        return created;
+    }
+    static int checkedTableBits(int tableBits) {
+        if (tableBits < GOBANG_MIN_TABLE_BITS || tableBits > GOBANG_MAX_TABLE_BITS)
+            throw std::out_of_range("GobangEngineHandle: table bits out of range");
+        return tableBits;
+    }
+public:
+    GobangEngineHandle(): engine(checked(createGobangEngine())) {}
+    explicit GobangEngineHandle(int tableBits): engine(checked(createGobangEngineWithTableBits(checkedTableBits(tableBits)))) {}
+    GobangEngineHandle(const GobangEngineHandle &) = delete;
+    GobangEngineHandle & operator =(const GobangEngineHandle &) = delete;
+    GobangEngineHandle(GobangEngineHandle && other) noexcept: engine(std::exchange(other.engine, nullptr)) {}
+    GobangEngineHandle & operator =(GobangEngineHandle && other) noexcept {
+        std::swap(engine, other.engine);
+        return *this;
+    }
+    ~GobangEngineHandle() {
+        if (engine) destroyGobangEngine(engine);
+    }
+    void setPosition(const char * board, int length) {
+        setGobangEnginePosition(engine, board, length);
+    }
+    void clear() {
+        clearGobangEngine(engine);
+    }
+    bool applyMove(int x, int y, int piece) {
+        return applyGobangEngineMove(engine, x, y, piece);
+    }
+    // False on invalid limits, with the result zeroed
+    bool search(GobangSearchResult & result, const GobangSearchLimits & limits = GobangSearchLimits()) {
+        result = GobangSearchResult();
+        return searchGobangEngine(engine, &limits, &result);
+    }
+    bool beginSearch(const GobangSearchLimits & limits = GobangSearchLimits()) {
+        return beginGobangEngineSearch(engine, &limits);
+    }
+    bool continueSearch(unsigned long long nodeBudget, GobangSearchResult & result) {
+        return continueGobangEngineSearch(engine, nodeBudget, &result);
+    }
+    void abandonSearch() {
+        abandonGobangEngineSearch(engine);
+    }
+    void stop() {
+        stopGobangEngine(engine);
+    }
+    GobangEngine * get() const {
+        return engine;
+    }
+};
+
+#endif
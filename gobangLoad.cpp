@@ -0,0 +1,166 @@
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include "gobang.h"
+#include "grid.hpp"
+#include "winJudge.h"
+
+/*
+    Loopback load generator for gobangServer.
+
+    Usage: gobangLoad [games] [moves per game] [target]
+    target is host:port for TCP or a Unix socket path (default gobang.sock).
+    Every game is one connection playing random moves next to the existing stones against the
+    server with incremental requests, until a five or the move count; request latency and
+    throughput are reported over all games.
+*/
+
+struct LoadTarget {
+    bool tcp = false;
+    std::string path = "gobang.sock";
+    std::string host;
+    int port = 0;
+} target;
+
+std::mutex latenciesMutex;
+std::vector<double> latencies; // Milliseconds per search request
+int failedGames = 0;
+
+int connectTarget() {
+    int fd;
+    if (target.tcp) {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(target.port);
+        if (fd == -1 || inet_pton(AF_INET, target.host.c_str(), &address.sin_addr) != 1 ||
+            connect(fd, (sockaddr *) &address, sizeof(address)) == -1) {
+            perror("connect failed");
+            if (fd != -1) close(fd);
+            return -1;
+        }
+        int noDelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    } else {
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        strncpy(address.sun_path, target.path.c_str(), sizeof(address.sun_path) - 1);
+        if (fd == -1 || connect(fd, (sockaddr *) &address, sizeof(address)) == -1) {
+            perror("connect failed");
+            if (fd != -1) close(fd);
+            return -1;
+        }
+    }
+    return fd;
+}
+
+// Send one request line and read one reply line
+bool exchange(int fd, const std::string & request, std::string & pending, std::string & reply) {
+    for (size_t sent = 0; sent < request.size();) {
+        ssize_t result = send(fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+        if (result <= 0) return false;
+        sent += result;
+    }
+    size_t newline;
+    while ((newline = pending.find('\n')) == std::string::npos) {
+        char buffer[0x1000];
+        ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received <= 0) return false;
+        pending.append(buffer, received);
+    }
+    reply = pending.substr(0, newline);
+    pending.erase(0, newline + 1);
+    return true;
+}
+
+bool playGame(int seed, int moves) {
+    int fd = connectTarget();
+    if (fd == -1) return false;
+    std::mt19937 random(seed);
+    ChessboardGrid board;
+    std::string pending, reply, request = "{\"type\":0}\n"; // The bot opens
+    std::vector<double> gameLatencies;
+    bool ok = true;
+    for (int move = 0; move < moves; move++) {
+        auto start = std::chrono::steady_clock::now();
+        int x, y;
+        if (!exchange(fd, request, pending, reply) ||
+            sscanf(reply.c_str(), "{\"response\":{\"x\":%d,\"y\":%d}}", &x, &y) != 2 ||
+            x < 0 || y < 0 || x >= SIZE || y >= SIZE || board.get(x, y) != EMPTY) {
+            fprintf(stderr, "game %d: bad reply \"%s\"\n", seed, reply.c_str());
+            ok = false;
+            break;
+        }
+        gameLatencies.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        board.set(x, y, BOT);
+        if (judgeWinsAt(board, x, y) != EMPTY) break;
+        // Random empty cell next to a stone
+        std::vector<ChessPosition> candidates;
+        for (int i = 0; i < SIZE; i++)
+            for (int j = 0; j < SIZE; j++) {
+                if (board.get(i, j) != EMPTY) continue;
+                bool adjacent = false;
+                for (int dx = -1; dx <= 1 && !adjacent; dx++)
+                    for (int dy = -1; dy <= 1 && !adjacent; dy++)
+                        adjacent = i + dx >= 0 && j + dy >= 0 && i + dx < SIZE && j + dy < SIZE && board.get(i + dx, j + dy) != EMPTY;
+                if (adjacent) candidates.emplace_back(i, j);
+            }
+        if (candidates.empty()) break;
+        ChessPosition player = candidates[random() % candidates.size()];
+        board.set(player.x, player.y, PLAYER);
+        if (judgeWinsAt(board, player.x, player.y) != EMPTY) break;
+        request = "{\"move\":{\"x\":" + std::to_string(player.x) + ",\"y\":" + std::to_string(player.y) + "},\"type\":0}\n";
+    }
+    close(fd);
+    std::lock_guard<std::mutex> lock(latenciesMutex);
+    latencies.insert(latencies.end(), gameLatencies.begin(), gameLatencies.end());
+    return ok;
+}
+
+int main(int argc, char ** argv) {
+    int games = argc > 1 ? atoi(argv[1]) : 16;
+    int moves = argc > 2 ? atoi(argv[2]) : 10;
+    if (argc > 3) {
+        std::string address = argv[3];
+        size_t colon = address.rfind(':');
+        if (colon != std::string::npos) {
+            target.tcp = true;
+            target.host = address.substr(0, colon);
+            target.port = atoi(address.c_str() + colon + 1);
+        } else target.path = address;
+    }
+    if (games <= 0 || moves <= 0) return 1;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int game = 0; game < games; game++)
+        threads.emplace_back([game, moves] {
+            if (!playGame(game, moves)) {
+                std::lock_guard<std::mutex> lock(latenciesMutex);
+                failedGames++;
+            }
+        });
+    for (std::thread & thread : threads) thread.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (latencies.empty()) return 1;
+    std::sort(latencies.begin(), latencies.end());
+    printf("%d games, %zu searches in %.2fs (%.1f/s), %d failed\n", games, latencies.size(), seconds, latencies.size() / seconds, failedGames);
+    printf("latency median %.1fms  p90 %.1fms  p99 %.1fms  max %.1fms\n", latencies[latencies.size() / 2],
+        latencies[latencies.size() * 9 / 10], latencies[latencies.size() * 99 / 100], latencies.back());
+    return failedGames ? 1 : 0;
+}
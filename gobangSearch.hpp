@@ -0,0 +1,604 @@
+#pragma once
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <queue>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include "gobang.h"
+#include "grid.hpp"
+
+//极大极小搜索的核心，全部状态都在Gobang对象中，因此多个对象可以在不同线程中同时搜索
+
+constexpr int MAX_DEPTH = 10; //迭代加深的最大搜索深度
+constexpr int SCORE_LENGTH = 6; //Score*数组的长度
+constexpr int SHIFT_LENGTH = 8; //*Shift数组的长度
+constexpr long long WIN_SCORE = 1000000000000000LL; //搜索中成五的终局分数，远大于任何局面评估分数
+constexpr uint64_t SEARCH_LIMIT_CHECK_INTERVAL = 1024; //每搜索多少个节点检查一次时间限制；节点数限制每个节点都检查
+
+struct PositionNode { //使用启发式评估对搜索落子顺序进行调整，从而便于α-β剪枝的数据结构
+	int x, y; //落子坐标位置
+	long long priority; //启发式评估的评估值
+	long long history; //历史启发分数，评估值相同时历史启发分数大的优先搜索
+	PositionNode(int x, int y, long long priority, long long history = 0) :x(x), y(y), priority(priority), history(history) {}
+	//评估值小的优先搜索的排序函数
+	bool cmpLess(const PositionNode& o1, const PositionNode& o2) const {
+		if (o1.priority == o2.priority) return o1.history < o2.history;
+		return o2.priority < o1.priority;
+	}
+	//评估值大的优先搜索的排序函数
+	bool cmpGreater(const PositionNode& o1, const PositionNode& o2) const {
+		if (o1.priority == o2.priority) return o1.history < o2.history;
+		return o1.priority < o2.priority;
+	}
+};
+//优先队列的排序方式，由搜索层数决定，保存在比较对象中而不是全局变量中，使多个引擎可以同时搜索
+struct PositionNodeCompare {
+	int sortMethod; //启发式评估用到的排序方式指示变量
+	/*
+	极大极小搜索函数根据当前搜索的层数选择使用排序方式：
+	当sortMethod为0时，是模拟机器人落子，此时应当优先搜索评估值大的落子方案，使得对于机器人利益最大化。
+	当sortMethod为1时，是模拟人类落子，此时应当优先搜索评估值小的落子方案，使得对于机器人利益最小化。
+	*/
+	bool operator ()(const PositionNode& o1, const PositionNode& o2) const {
+		if (sortMethod == 0) return o1.cmpGreater(o1, o2);
+		else return o1.cmpLess(o1, o2);
+	}
+};
+//置换表用到的Zobrist哈希键，编译期由SplitMix64生成
+struct ZobristTable {
+	uint64_t piece[PIECE_END][SIZE][SIZE];
+	uint64_t playerToMove; //轮到人类落子时异或到局面哈希中
+	static constexpr uint64_t next(uint64_t & seed) {
+		uint64_t z = (seed += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+	constexpr ZobristTable(): piece(), playerToMove() {
+		uint64_t seed = 0x476F62616E67ull;
+		for (int k = 0; k < PIECE_END; k++)
+			for (int i = 0; i < SIZE; i++)
+				for (int j = 0; j < SIZE; j++)
+					piece[k][i][j] = next(seed);
+		playerToMove = next(seed);
+	}
+};
+constexpr ZobristTable zobrist;
+
+enum TranspositionBound : uint8_t {
+	BOUND_EXACT, //精确值
+	BOUND_LOWER, //下界（发生β剪枝）
+	BOUND_UPPER //上界（发生α剪枝或没有超过α）
+};
+struct TranspositionEntry { //置换表项
+	uint64_t key; //局面哈希（含轮到哪一方落子）
+	long long score; //相对于该局面评估分数的搜索分数，成五分数则记录相对于该层的距离
+	int8_t x, y; //最优落子，没有时为-1
+	uint8_t depth; //该局面向下搜索的层数
+	uint8_t bound; //TranspositionBound
+	uint16_t age; //写入时的搜索代数，用于替换策略
+	uint16_t generation; //写入时置换表的清空代数，与当前代数不同的表项视为空
+};
+constexpr int TRANSPOSITION_TABLE_BITS = 20; //置换表大小为2^20项
+constexpr int HISTORY_SCORE_SHIFT = 1; //每次选择落子前历史启发分数衰减为原来的一半
+
+struct Gobang {
+	ChessboardGrid grid; //经位图优化的二维模拟棋盘
+	uint32_t lineGeneration[CHESSBOARD_LINE_COUNT]; //每条棋盘线的修改代数，线上任一格子改变时加一
+	uint32_t unitDiffGeneration[PIECE_END][SIZE][SIZE][CHESSBOARD_LINE_TYPE_COUNT]; //记忆化评估差分分数时，经过该格子的四条棋盘线的代数
+	long long unitDiffStorage[PIECE_END][SIZE][SIZE]; //记忆化的评估差分分数
+	ChessPosition principalVariation[MAX_DEPTH + 1][MAX_DEPTH + 1]; //三角形主要变例表，第depth行为从该层开始的最优落子序列
+	int principalVariationLength[MAX_DEPTH + 1]; //主要变例表每行的结束位置
+	ChessPosition expectedReply; //最近一次选择落子时，主要变例中人类的预期应对
+	bool hasExpectedReply = false;
+	uint64_t zobristKey = 0; //当前棋盘的Zobrist哈希
+	std::vector<TranspositionEntry> transpositionTable; //在各步之间保留的置换表
+	uint64_t transpositionTableMask;
+	uint16_t searchAge = 0; //搜索代数，每次选择落子加一
+	uint16_t transpositionGeneration = 0; //置换表的清空代数，清空置换表时加一，使已有的表项全部失效而不必改写整张表
+	long long historyScore[PIECE_END][SIZE][SIZE]; //历史启发分数，在各步之间保留并逐步衰减
+	int lastCompletedDepth = 0; //上一次选择落子时完整搜索过的最大深度
+	uint64_t expectedPositionKey = 0; //上一次选择落子后，机器人落子、人类按主要变例应对所到达局面的哈希，没有预期应对时为0
+	int DEPTH; //极大极小搜索深度
+	std::atomic<bool> terminateIndicator{false}; //中止搜索的请求，可由其他线程或信号处理函数设置
+	uint64_t searchedNodes = 0; //本次选择落子已搜索的节点数
+	uint64_t nodeLimit = 0; //节点数限制，0为不限制
+	bool hasDeadline = false;
+	std::chrono::steady_clock::time_point deadline; //时间限制
+	//搜索栈的一层，保存递归版本中一次极大极小搜索调用的局部状态
+	struct SearchFrame {
+		long long alpha, beta, evaluationValue;
+		long long selectedScore; //极大层为当前的α值，极小层为当前的β值
+		ChessPiece piece;
+		int remainingDepth;
+		std::vector<PositionNode> moves; //排好序的落子，在各次搜索之间复用容量
+		size_t nextMove; //正在搜索的落子在moves中的下标
+		ChessPosition bestMove;
+	};
+	SearchFrame searchStack[MAX_DEPTH]; //第depth项为第depth层；叶子层不入栈
+	int searchStackTop = -1; //栈顶层数，-1表示没有进行中的搜索
+	ChessPosition rootMove; //第0层选中的落子
+	long long rootScore = 0;
+	bool choosingPosition = false; //迭代加深尚未完成
+	int searchMaxDepth = MAX_DEPTH;
+	long long bestEvaluationValue = INT64_MIN;
+	ChessPosition chosenPosition; //选择的落子
+	//XShift和YShift数组是程序搜索过程中遍历指定方格的邻接方格的偏移量
+	const int XShift[SHIFT_LENGTH] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+	const int YShift[SHIFT_LENGTH] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+	//死棋的评估分数（有一头被堵住，另一头没有被堵住，只有一头可以继续下棋）
+	const long long Score_E1[SCORE_LENGTH] = { 0, 1, 5, 25, 1250, 1000000 };
+	//活棋的评估分数（两头没有被堵住，都可以下棋）
+	const long long Score_E2[SCORE_LENGTH] = { 0, 5, 20, 200, 1500, 1000000 };
+
+	//将类型为value的棋子落子在棋盘(x,y)坐标，成功返回true，坐标不存在返回false
+	inline bool placeAt(int x, int y, ChessPiece value, bool invalidate = true) {
+		if (x >= 0 && y >= 0 && x < SIZE && y < SIZE) {
+			ChessPiece previous = grid.get(x, y);
+			if (invalidate) {
+				if (previous != value) invalidateUnitDiff(x, y);
+			}
+			if (previous != EMPTY) zobristKey ^= zobrist.piece[previous - PIECE_START][x][y];
+			if (value == BOT || value == PLAYER) zobristKey ^= zobrist.piece[value - PIECE_START][x][y];
+			grid.set(x, y, value);
+			return true;
+		}
+		return false;
+	}
+	//获得棋盘上(x,y)坐标位置的棋子类型，若坐标不存在返回NOT_EXIST
+	inline ChessPiece getValueAt(int x, int y) {
+		if (x >= 0 && y >= 0 && x < SIZE && y < SIZE)
+			return grid.get(x, y);
+		else
+			return NOT_EXIST;
+	}
+	//传入棋子类型status，连续棋子数cnt，两边有几边是空的edgeSituation，获取当前连续棋子的评估分数
+	inline long long getScore(ChessPiece status, int cnt, int edgeSituation) const {
+		//当两边都被堵住时，如果在中间下棋有可能成五，需要返回一个评估值，解决了不堵中间的Bug
+		if (edgeSituation == 0) {
+			switch (status) {
+			case BOT:
+				return cnt == 5 ? Score_E2[5] : 0;
+			case PLAYER:
+				return -(cnt == 5 ? Score_E2[5] : 0);
+			default:
+				return 0;
+			}
+		}
+		//两边有一边为空或两边都为空时，到Score_E1和Score_E2数组中去查找对应的棋子评估分数并返回
+		else if (edgeSituation == 1) {
+			switch (status) {
+			case BOT:
+				return cnt >= SCORE_LENGTH ? Score_E1[SCORE_LENGTH - 1] : Score_E1[cnt];
+			case PLAYER:
+				return -(cnt >= SCORE_LENGTH ? Score_E1[SCORE_LENGTH - 1] : Score_E1[cnt]);
+			default:
+				return 0;
+			}
+		}
+		else { // edgeSituation==2
+			switch (status) {
+			case BOT:
+				return cnt >= SCORE_LENGTH ? Score_E2[SCORE_LENGTH - 1] : Score_E2[cnt];
+			case PLAYER:
+				return -(cnt >= SCORE_LENGTH ? Score_E2[SCORE_LENGTH - 1] : Score_E2[cnt]);
+			default:
+				return 0;
+			}
+		}
+	}
+	//传入两边的棋子状态，计算两边为空的位置格数
+	inline int calculateEdgeSituation(ChessPiece leftEdgeStatus, ChessPiece rightEdgeStatus) const {
+		int cnt = 0;
+		if (EMPTY == leftEdgeStatus)
+			cnt++;
+		if (EMPTY == rightEdgeStatus)
+			cnt++;
+		return cnt;
+	}
+	//计算ChessboardLine line所指定的连成一条线上的棋子的评估分数
+	template <BitKernelISA ISA = BitKernelISA::GENERIC>
+	long long SequenceEvaluate(ChessboardLine &line, ChessPiece * isFinished = NULL) {
+		long long sum = 0;
+
+		auto lambda = [&] (ChessPiece currentPiece, int count, int, ChessPiece leftOutOfBoundPiece, ChessPiece rightOutOfBoundPiece) {
+			sum += getScore(currentPiece, count, calculateEdgeSituation(rightOutOfBoundPiece, leftOutOfBoundPiece));
+			if (isFinished && currentPiece != EMPTY && count >= 5) *isFinished = currentPiece;
+		};
+
+		grid.lambdaForTraverseChessboardLine<ISA>(line, lambda);
+		return sum;
+	}
+	//计算由棋盘线掩码botMask、playerMask（1为有子）所描述的一条长为size的线上的棋子的评估分数，不访问棋盘
+	template <BitKernelISA ISA = BitKernelISA::GENERIC>
+	long long MaskSequenceEvaluate(uint64_t botMask, uint64_t playerMask, uint64_t size) const {
+		long long sum = 0;
+		ChessboardGrid::lambdaForTraverseLineMasks<ISA>(botMask, playerMask, size,
+			[&] (ChessPiece currentPiece, int count, int, ChessPiece leftOutOfBoundPiece, ChessPiece rightOutOfBoundPiece) {
+				sum += getScore(currentPiece, count, calculateEdgeSituation(rightOutOfBoundPiece, leftOutOfBoundPiece));
+			}
+		);
+		return sum;
+	}
+	//评估坐标(x,y)处所对应的分数
+	template <BitKernelISA ISA = BitKernelISA::GENERIC>
+	long long EvaluateUnit(int x, int y, ChessPiece * isFinished = NULL) {
+		long long sum = 0;
+		constexpr int ChessboardLineCount = 4;
+		ChessboardLine ChessboardLineArr[ChessboardLineCount] = {
+			ChessboardLine(ChessboardLineType::LINE, x, 0), // 行
+			ChessboardLine(ChessboardLineType::ROW, 0, y), // 列
+			ChessboardLine(ChessboardLineType::ULLRDiagonal, x, y), // 左上-右下对角线
+			ChessboardLine(ChessboardLineType::LLURDiagonal, x, y) // 右上-左下对角线
+		};
+		for (int k = 0; k < ChessboardLineCount; k++) {
+			sum += SequenceEvaluate<ISA>(ChessboardLineArr[k], isFinished);
+		}
+		return sum;
+	}
+	// 差分地使记忆化评估差分分数无效：只需增加经过(x,y)的四条棋盘线的代数
+	void invalidateUnitDiff(int x, int y) {
+		for (int k = 0; k < CHESSBOARD_LINE_TYPE_COUNT; k++)
+			lineGeneration[chessboardLayout.cellLines[x][y][k].slot]++;
+	}
+	// 记忆化的评估差分分数仅依赖经过(x,y)的四条棋盘线，记录时的代数与当前代数一致则仍然有效
+	inline bool isUnitDiffValid(ChessPiece piece, int x, int y) {
+		for (int k = 0; k < CHESSBOARD_LINE_TYPE_COUNT; k++) {
+			if (unitDiffGeneration[piece - PIECE_START][x][y][k] != lineGeneration[chessboardLayout.cellLines[x][y][k].slot])
+				return false;
+		}
+		return true;
+	}
+	//只读地评估在坐标(x,y)处落子时，对总评估分数会产生的差值：
+	//仅读取经过(x,y)的四条棋盘线掩码，将落子位置并入掩码后计算差值，不修改棋盘，可在多线程共享棋盘时调用
+	template <BitKernelISA ISA = BitKernelISA::GENERIC>
+	long long EvaluateMoveDelta(ChessPiece piece, int x, int y) const {
+		long long sum = 0;
+		for (int k = 0; k < CHESSBOARD_LINE_TYPE_COUNT; k++) {
+			const ChessboardLayout::CellLine & cell = chessboardLayout.cellLines[x][y][k];
+			uint64_t bit = 1ull << cell.index, size = chessboardLayout.lineSize[cell.slot];
+			uint64_t botMask = grid.getLineMask(BOT, cell.slot) & ~bit, playerMask = grid.getLineMask(PLAYER, cell.slot) & ~bit;
+			sum -= MaskSequenceEvaluate<ISA>(botMask, playerMask, size);
+			if (piece == BOT) botMask |= bit;
+			else playerMask |= bit;
+			sum += MaskSequenceEvaluate<ISA>(botMask, playerMask, size);
+		}
+		return sum;
+	}
+	//评估在坐标(x,y)处落子时，对总评估分数会产生的差值，这样可以加快搜索速度
+	//落子种类由搜索深度决定
+	template <BitKernelISA ISA = BitKernelISA::GENERIC>
+	long long EvaluateUnitDiff(ChessPiece piece, int x, int y) {
+		if (isUnitDiffValid(piece, x, y))
+			return unitDiffStorage[piece - PIECE_START][x][y];
+		for (int k = 0; k < CHESSBOARD_LINE_TYPE_COUNT; k++)
+			unitDiffGeneration[piece - PIECE_START][x][y][k] = lineGeneration[chessboardLayout.cellLines[x][y][k].slot];
+		return unitDiffStorage[piece - PIECE_START][x][y] = EvaluateMoveDelta<ISA>(piece, x, y);
+	}
+	//第depth层选中落子(i,j)后，以它和下一层的主要变例组成本层的主要变例
+	inline void updatePrincipalVariation(int depth, int i, int j) {
+		principalVariation[depth][depth] = ChessPosition(i, j);
+		for (int k = depth + 1; k < principalVariationLength[depth + 1]; k++)
+			principalVariation[depth][k] = principalVariation[depth + 1][k];
+		principalVariationLength[depth] = std::max(principalVariationLength[depth + 1], depth + 1);
+	}
+	//成五的分数与落子的层数有关，置换表中记录相对于当前层的分数，使其与到达该局面的路径无关
+	static bool isWinScore(long long score) {
+		return score > WIN_SCORE / 2 || score < -WIN_SCORE / 2;
+	}
+	static long long toTranspositionScore(long long score, int depth, long long evaluationValue) {
+		if (isWinScore(score)) return score > 0 ? score + depth : score - depth;
+		return score - evaluationValue;
+	}
+	static long long fromTranspositionScore(long long score, int depth, long long evaluationValue) {
+		if (isWinScore(score)) return score > 0 ? score - depth : score + depth;
+		return score + evaluationValue;
+	}
+	inline uint64_t positionKey(int depth) const {
+		return depth % 2 == 0 ? zobristKey : zobristKey ^ zobrist.playerToMove;
+	}
+	//替换策略：旧代数的表项总是被替换，同代数的表项只被搜索层数不少于它的结果替换
+	void storeTransposition(int depth, long long score, TranspositionBound bound, const ChessPosition & best, long long evaluationValue) {
+		if (terminateIndicator.load(std::memory_order_relaxed)) return; //搜索被中止时结果不完整，不写入置换表
+		if (score == INT64_MIN || score == INT64_MAX) return;
+		uint64_t key = positionKey(depth);
+		TranspositionEntry & entry = transpositionTable[key & transpositionTableMask];
+		if (entry.generation != transpositionGeneration || entry.key == key || entry.age != searchAge || DEPTH - depth >= entry.depth) {
+			entry.key = key;
+			entry.score = toTranspositionScore(score, depth, evaluationValue);
+			entry.x = best.x;
+			entry.y = best.y;
+			entry.depth = DEPTH - depth;
+			entry.bound = bound;
+			entry.age = searchAge;
+			entry.generation = transpositionGeneration;
+		}
+	}
+	//每个节点检查节点数限制，每搜索SEARCH_LIMIT_CHECK_INTERVAL个节点检查一次时间限制，超出时中止搜索
+	inline void checkSearchLimits() {
+		++searchedNodes;
+		if ((nodeLimit && searchedNodes >= nodeLimit) ||
+			(searchedNodes % SEARCH_LIMIT_CHECK_INTERVAL == 0 && hasDeadline && std::chrono::steady_clock::now() >= deadline))
+			terminateIndicator.store(true, std::memory_order_relaxed);
+	}
+	//进入第depth层节点：到达边界深度或置换表命中时直接得到分数*score并返回false，
+	//否则生成并排序可以落子的位置，将该层压入搜索栈并返回true
+	template <BitKernelISA ISA>
+	bool enterSearchNode(int depth, long long alpha, long long beta, long long evaluationValue, long long * score) {
+		//depth%2==0时为BOT，depth%2==1时为PLAYER
+		principalVariationLength[depth] = depth;
+		checkSearchLimits();
+		if (depth == DEPTH) { //到达边界深度时，结束搜索，直接返回棋局评估分数
+			*score = evaluationValue;
+			return false;
+		}
+		ChessPiece piece = depth % 2 == 0 ? BOT : PLAYER;
+		int remainingDepth = DEPTH - depth;
+		//查找置换表：层数足够时直接使用记录的分数，否则只用记录的最优落子调整搜索顺序
+		ChessPosition transpositionMove(-1, -1);
+		const TranspositionEntry & entry = transpositionTable[positionKey(depth) & transpositionTableMask];
+		if (entry.key == positionKey(depth) && entry.generation == transpositionGeneration) {
+			transpositionMove = ChessPosition(entry.x, entry.y);
+			if (depth > 0 && entry.depth >= remainingDepth) {
+				long long transpositionScore = fromTranspositionScore(entry.score, depth, evaluationValue);
+				if (entry.bound == BOUND_EXACT && transpositionScore > alpha && transpositionScore < beta) {
+					*score = transpositionScore;
+					return false;
+				}
+				if (entry.bound != BOUND_UPPER && transpositionScore >= beta) {
+					*score = beta;
+					return false;
+				}
+				if (entry.bound != BOUND_LOWER && transpositionScore <= alpha) {
+					*score = alpha;
+					return false;
+				}
+			}
+		}
+		SearchFrame & frame = searchStack[depth];
+		frame.alpha = alpha;
+		frame.beta = beta;
+		frame.evaluationValue = evaluationValue;
+		frame.selectedScore = depth % 2 == 0 ? alpha : beta; //根据是极大层还是极小层决定剪枝的边界分数是α还是β
+		frame.piece = piece;
+		frame.remainingDepth = remainingDepth;
+		//根据搜索层数选择启发式评估的排序方式，使用优先队列对启发式评估的落子位置排序
+		std::priority_queue<PositionNode, std::vector<PositionNode>, PositionNodeCompare> pq(PositionNodeCompare{ depth % 2 });
+		//循环遍历整个棋盘，寻找可以落子的位置
+		for (int i = 0; i < SIZE; i++) {
+			for (int j = 0; j < SIZE; j++) {
+				if (getValueAt(i, j) != EMPTY) //当前格子不为空时，不能落子，跳过
+					continue;
+				bool flag = false;
+				for (int k = 0; k < SHIFT_LENGTH; k++) {
+					//当前格子周围邻接的格子如果有子，就把它当成一个可能的落子位置并加以评估
+					int value = getValueAt(i + XShift[k], j + YShift[k]);
+					if (value == PLAYER || value == BOT) {
+						flag = true;
+						break;
+					}
+				}
+				if (flag) //启发式评估成功之后加入优先队列进行排序
+					pq.emplace(i, j, EvaluateUnitDiff<ISA>(piece, i, j), historyScore[piece - PIECE_START][i][j]);
+			}
+		}
+		//在向下搜索前取出全部落子；置换表中的最优落子最先搜索
+		frame.moves.clear();
+		while (!pq.empty()) {
+			frame.moves.push_back(pq.top());
+			pq.pop();
+			if (frame.moves.back().x == transpositionMove.x && frame.moves.back().y == transpositionMove.y)
+				std::rotate(frame.moves.begin(), frame.moves.end() - 1, frame.moves.end());
+		}
+		if (depth == 0 && !frame.moves.empty()) //若深度为0的话，首先选择启发式评估值最大的落子情况初始化返回的落子位置
+			rootMove = ChessPosition(frame.moves.front().x, frame.moves.front().y);
+		frame.nextMove = 0;
+		frame.bestMove = ChessPosition(-1, -1);
+		searchStackTop = depth;
+		return true;
+	}
+	//搜索栈顶层的落子全部搜索完毕（或搜索被中止）时，更新历史启发分数与置换表，弹出该层并返回它的分数
+	long long leaveSearchNode() {
+		int depth = searchStackTop;
+		SearchFrame & frame = searchStack[depth];
+		int remainingDepth = frame.remainingDepth;
+		if (frame.bestMove.x >= 0) historyScore[frame.piece - PIECE_START][frame.bestMove.x][frame.bestMove.y] += remainingDepth * remainingDepth;
+		//没有落子超过α（极大层）或低于β（极小层）时，得到的只是一个界
+		if (frame.bestMove.x < 0) storeTransposition(depth, frame.selectedScore, depth % 2 == 0 ? BOUND_UPPER : BOUND_LOWER, frame.bestMove, frame.evaluationValue);
+		else storeTransposition(depth, frame.selectedScore, BOUND_EXACT, frame.bestMove, frame.evaluationValue);
+		searchStackTop = depth - 1;
+		return frame.selectedScore; //如果没有剪枝，返回最终的棋局评估结果
+	}
+	//极大极小搜索与α-β剪枝搜索：开始搜索根节点，随后由resumeMinimaxSearch推进
+	template <BitKernelISA ISA>
+	void beginMinimaxSearch() {
+		long long score;
+		searchStackTop = -1;
+		if (!enterSearchNode<ISA>(0, INT64_MIN, INT64_MAX, 0, &score))
+			rootScore = score;
+	}
+	//以显式的搜索栈代替递归，在搜索下一个落子前检查本次的节点数配额，用完时让出，棋盘保留在搜索中的状态；
+	//之后再次调用即从让出处继续。根节点搜索完毕时返回true，根节点的分数在rootScore中，落子在rootMove中
+	template <BitKernelISA ISA>
+	bool resumeMinimaxSearch(uint64_t nodeBudget) {
+		uint64_t sliceStart = searchedNodes;
+		long long curScore = 0;
+		bool hasChildScore = false; //栈顶层的当前落子已经得到分数curScore，尚未处理；让出只发生在没有待处理分数时
+		while (searchStackTop >= 0) {
+			int depth = searchStackTop;
+			SearchFrame & frame = searchStack[depth];
+			if (!hasChildScore) {
+				if (frame.nextMove == frame.moves.size()) {
+					curScore = leaveSearchNode();
+					if (depth == 0) rootScore = curScore;
+					hasChildScore = true;
+					continue;
+				}
+				if (searchedNodes - sliceStart >= nodeBudget) //本次的节点数配额用完，让出
+					return false;
+				//取出评估落子情况用的数据结构并准备向下搜索
+				const PositionNode & curPositionNode = frame.moves[frame.nextMove];
+				int i = curPositionNode.x, j = curPositionNode.y;
+				placeAt(i, j, frame.piece, true); //根据搜索层数选择落子类型是机器人还是人类
+				if (grid.isFiveAt(frame.piece, i, j)) { //落子成五时棋局结束，不再向下搜索；越早成五分数越极端
+					curScore = depth % 2 == 0 ? WIN_SCORE - depth : -(WIN_SCORE - depth);
+					principalVariationLength[depth + 1] = depth + 1;
+					hasChildScore = true;
+				}
+				else if (depth % 2 == 0) { // 极大层节点时，继续搜索极小层节点
+					hasChildScore = !enterSearchNode<ISA>(depth + 1, frame.selectedScore, frame.beta, frame.evaluationValue + curPositionNode.priority, &curScore);
+				}
+				else { // 极小层节点时，继续搜索极大层节点
+					hasChildScore = !enterSearchNode<ISA>(depth + 1, frame.alpha, frame.selectedScore, frame.evaluationValue + curPositionNode.priority, &curScore);
+				}
+				continue;
+			}
+			//第depth+1层返回了分数curScore，回到第depth层的当前落子
+			hasChildScore = false;
+			int i = frame.moves[frame.nextMove].x, j = frame.moves[frame.nextMove].y;
+			int remainingDepth = frame.remainingDepth;
+			if (depth % 2 == 0) { //极大层节点，取最大的棋局评估值更新α值
+				if (frame.selectedScore < curScore) {
+					frame.selectedScore = curScore;
+					frame.bestMove = ChessPosition(i, j);
+					updatePrincipalVariation(depth, i, j);
+					if (depth == 0) //当搜索深度为0时，更新返回的落子位置
+						rootMove = ChessPosition(i, j);
+				}
+			}
+			else { //极小层节点，取最小的棋局评估值更新β值
+				if (frame.selectedScore > curScore) {
+					frame.selectedScore = curScore;
+					frame.bestMove = ChessPosition(i, j);
+					updatePrincipalVariation(depth, i, j);
+				}
+			}
+			placeAt(i, j, EMPTY, true); //回溯
+			//α-β剪枝：更新历史启发分数与置换表后弹出该层，把边界分数返回上一层
+			if (depth % 2 == 0 ? frame.selectedScore >= frame.beta : frame.selectedScore <= frame.alpha) {
+				historyScore[frame.piece - PIECE_START][i][j] += remainingDepth * remainingDepth;
+				if (depth % 2 == 0) { //极大层进行β剪枝
+					storeTransposition(depth, frame.selectedScore, BOUND_LOWER, frame.bestMove, frame.evaluationValue);
+					curScore = frame.beta;
+				}
+				else { //极小层进行α剪枝
+					storeTransposition(depth, frame.selectedScore, BOUND_UPPER, frame.bestMove, frame.evaluationValue);
+					curScore = frame.alpha;
+				}
+				searchStackTop = depth - 1;
+				if (depth == 0) rootScore = curScore;
+				hasChildScore = true;
+				continue;
+			}
+			if (terminateIndicator.load(std::memory_order_relaxed)) frame.nextMove = frame.moves.size();
+			else frame.nextMove++;
+		}
+		return true;
+	}
+	//放弃让出中的搜索：撤销搜索栈中各层已经落下的棋子，恢复搜索前的棋盘
+	void abandonMinimaxSearch() {
+		//让出时栈顶层的当前落子尚未落下，其余各层的当前落子都在棋盘上
+		for (int depth = searchStackTop - 1; depth >= 0; depth--) {
+			const PositionNode & node = searchStack[depth].moves[searchStack[depth].nextMove];
+			placeAt(node.x, node.y, EMPTY, true);
+		}
+		searchStackTop = -1;
+	}
+	//开始可恢复的选择落子，maxDepth为迭代加深的最大深度；之后由continueChoosePosition推进
+	void beginChoosePosition(int maxDepth = MAX_DEPTH) {
+		hasExpectedReply = false;
+		searchAge++;
+		for (int k = 0; k < PIECE_END; k++)
+			for (int i = 0; i < SIZE; i++)
+				for (int j = 0; j < SIZE; j++)
+					historyScore[k][i][j] >>= HISTORY_SCORE_SHIFT;
+		chosenPosition = ChessPosition();
+		choosingPosition = false;
+		bestEvaluationValue = INT64_MIN;
+		if (grid.countPieces() != 0) { //机器人后手的情况
+			//人类按主要变例应对时，上一步已经搜索过当前局面以下DEPTH-2层的子树，并保存在置换表中，因此从更深的层数开始；
+			//否则置换表中没有当前局面的子树，从4层开始，以免第一次迭代在限制内无法完成
+			searchMaxDepth = maxDepth;
+			int startDepth = zobristKey == expectedPositionKey ? std::max(4, lastCompletedDepth - 2) : 4;
+			DEPTH = std::min(startDepth, maxDepth);
+			lastCompletedDepth = 0;
+			expectedPositionKey = 0;
+			choosingPosition = DEPTH <= maxDepth;
+			if (choosingPosition) dispatchBitKernel(activeBitKernelISA, [this] (auto isa) { beginMinimaxSearch<decltype(isa)::value>(); });
+		}
+		else { //机器人先手落子在棋盘中心
+			chosenPosition = ChessPosition(7, 7);
+		}
+	}
+	//继续选择落子，本次最多搜索nodeBudget个节点；选择完毕时返回true，落子在chosenPosition中
+	//按选定的位运算内核分派一次，整个搜索以该内核的指令集编译，内核函数得以内联
+	bool continueChoosePosition(uint64_t nodeBudget = UINT64_MAX) {
+		return dispatchBitKernel(activeBitKernelISA, [this, nodeBudget] (auto isa) { return continueChoosePosition<decltype(isa)::value>(nodeBudget); });
+	}
+	template <BitKernelISA ISA>
+	bool continueChoosePosition(uint64_t nodeBudget) {
+		uint64_t sliceStart = searchedNodes;
+		while (choosingPosition) { //分别搜索startDepth~maxDepth层的情况，取最优解，如果超时可中途退出
+			uint64_t used = searchedNodes - sliceStart;
+			if (used >= nodeBudget || !resumeMinimaxSearch<ISA>(nodeBudget - used)) return false;
+			if (!terminateIndicator) lastCompletedDepth = DEPTH;
+			if (rootScore > bestEvaluationValue) {
+				chosenPosition = rootMove;
+				bestEvaluationValue = rootScore;
+				hasExpectedReply = principalVariationLength[0] >= 2 &&
+					principalVariation[0][0].x == rootMove.x && principalVariation[0][0].y == rootMove.y;
+				if (hasExpectedReply) expectedReply = principalVariation[0][1];
+			}
+			DEPTH += 2;
+			//中止后不再开始更深的迭代，否则每次迭代都会沿第一个落子搜索到叶子，超出节点数限制
+			choosingPosition = DEPTH <= searchMaxDepth && !terminateIndicator;
+			if (choosingPosition) beginMinimaxSearch<ISA>();
+			else if (hasExpectedReply) //搜索结束时棋盘已恢复为根局面
+				expectedPositionKey = zobristKey ^ zobrist.piece[BOT - PIECE_START][chosenPosition.x][chosenPosition.y] ^
+					zobrist.piece[PLAYER - PIECE_START][expectedReply.x][expectedReply.y];
+		}
+		return true;
+	}
+	//放弃未完成的选择落子，棋盘恢复到开始选择时的局面
+	void abandonChoosePosition() {
+		if (choosingPosition) abandonMinimaxSearch();
+		choosingPosition = false;
+	}
+	//选择落子位置的函数，maxDepth为迭代加深的最大深度
+	inline ChessPosition ChoosePosition(int maxDepth = MAX_DEPTH)
+	{
+		beginChoosePosition(maxDepth);
+		continueChoosePosition();
+		return chosenPosition;
+	}
+	//清空棋盘；记忆化表依靠代数失效、置换表依靠局面哈希区分，因此可以继续保留
+	void reset() {
+		for (int i = 0; i < SIZE; i++) {
+			for (int j = 0; j < SIZE; j++) {
+				placeAt(i, j, EMPTY);
+			}
+		}
+		lastCompletedDepth = 0;
+		expectedPositionKey = 0;
+	}
+	//清空置换表与历史启发分数，此后的搜索与新建的对象相同；记忆化表只依赖棋盘，不需要清空
+	//置换表依靠清空代数失效，只有代数回绕到0、旧表项可能重新生效时才改写整张表
+	void clearSearchHistory() {
+		if (++transpositionGeneration == 0)
+			std::fill(transpositionTable.begin(), transpositionTable.end(), TranspositionEntry());
+		memset(historyScore, 0, sizeof(historyScore));
+		searchAge = 0;
+		lastCompletedDepth = 0;
+		expectedPositionKey = 0;
+	}
+	//置换表大小为2^transpositionTableBits项，同时运行大量对局时可以取小一些
+	explicit Gobang(int transpositionTableBits = TRANSPOSITION_TABLE_BITS):
+		transpositionTable(1ull << transpositionTableBits), transpositionTableMask((1ull << transpositionTableBits) - 1) {
+		//代数从1开始，全零的记录代数因此一开始都是无效的
+		std::fill(lineGeneration, lineGeneration + CHESSBOARD_LINE_COUNT, 1);
+		memset(unitDiffGeneration, 0, sizeof(unitDiffGeneration));
+		memset(historyScore, 0, sizeof(historyScore));
+	}
+};
@@ -0,0 +1,449 @@
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include "gobang.h"
+#include "grid.hpp"
+#include "winJudge.h"
+#include "engineProtocolJson.hpp"
+#include "gobangEngine.h"
+#include "searchScheduler.hpp"
+
+/*
+    Multi-game engine server.
+
+    Every connection is one game and speaks the keep-running JSON line protocol of gobang:
+    full history requests or incremental setup/move requests, type 0 to search, type 1 to judge.
+    Games only hold their board; searches are resumable and time-sliced fairly on a fixed pool of
+    workers, so a long search does not hold up the moves of other games, and an engine is only held
+    while a search is in flight. One epoll thread does all socket I/O and judging.
+
+    Configuration:
+        SERVER_SOCKET: Unix domain socket path (default gobang.sock, empty to disable)
+        SERVER_PORT: TCP port (default 7777, 0 to disable)
+        SERVER_HOST: IPv4 address the TCP port is bound to (default 127.0.0.1; the engine has no
+            authentication, so other addresses, or 0.0.0.0 for all interfaces, are an explicit opt-in)
+        SERVER_WORKERS: search threads (default: hardware threads)
+        SERVER_SLICE_NODES: nodes a search runs before yielding its thread to the next game (default 2048)
+        SERVER_NODE_QUOTA: per-move node limit (default 0, none)
+        SERVER_TABLE_BITS: transposition table size of each engine as a power of two (default 16)
+        TIMEOUT: per-move time limit in seconds, counted from the request's arrival (default 1, 0 for none)
+*/
+
+constexpr size_t MAX_REQUEST_LINE = 0x10000; // Longer lines close the connection
+constexpr size_t MAX_BUFFERED_INPUT = 4 * MAX_REQUEST_LINE; // So do more pipelined lines than this waiting for a search
+constexpr int MAX_EPOLL_EVENTS = 256;
+// epoll tags below FIRST_GAME_ID are the server's own descriptors
+constexpr uint64_t UNIX_LISTENER_ID = 1, TCP_LISTENER_ID = 2, COMPLETION_ID = 3, SIGNAL_ID = 4, FIRST_GAME_ID = 16;
+
+struct ServerConfig {
+    std::string socketPath = "gobang.sock";
+    std::string host = "127.0.0.1";
+    int port = 7777;
+    int workers = std::max(1u, std::thread::hardware_concurrency());
+    unsigned int timeLimitMs = 1000;
+    unsigned long long sliceNodes = 2048;
+    unsigned long long nodeQuota = 0;
+    int tableBits = 16;
+} config;
+
+struct Game {
+    int fd;
+    std::string input, output;
+    size_t outputOffset = 0;
+    ChessboardGrid board;
+    ChessPosition lastMove = ChessPosition(-1, -1); // Known for incremental requests only
+    bool incremental = false; // Protocol of the request being searched
+    bool searching = false; // A search job is queued or running; later lines wait
+    GobangEngine * engine = nullptr; // Engine of that search, stopped if the game closes first
+    bool peerClosed = false;
+    bool writable = true; // EPOLLOUT not requested
+};
+
+struct SearchDone {
+    uint64_t gameId;
+    ChessPosition move;
+    GobangEngine * engine;
+};
+
+// Searches of all games time-sliced by a SearchScheduler, reporting through an eventfd watched by the
+// epoll loop. Engines are reused from a free list, so memory follows the searches in flight, not the games.
+class SearchPool {
+    std::vector<GobangEngineHandle> engines; // Declared before the scheduler, which must stop using them first
+    std::vector<GobangEngine *> idleEngines;
+    std::vector<SearchDone> done;
+    std::mutex doneMutex;
+    int completionFd;
+    SearchScheduler scheduler;
+
+public:
+    SearchPool(int workerCount, int completionFd): completionFd(completionFd), scheduler(workerCount, config.sliceNodes) {}
+    // Time spent waiting for a slice counts against the deadline, which starts now. Returns the
+    // engine running the search
+    GobangEngine * submit(uint64_t gameId, const char * board) {
+        if (idleEngines.empty()) {
+            engines.emplace_back(config.tableBits);
+            idleEngines.push_back(engines.back().get());
+        }
+        GobangEngine * engine = idleEngines.back();
+        idleEngines.pop_back();
+        setGobangEnginePosition(engine, board, SIZE * SIZE);
+        GobangSearchLimits limits = {};
+        limits.timeLimitMs = config.timeLimitMs;
+        limits.nodeLimit = config.nodeQuota;
+        // Limits without a depth are always valid, so the scheduler accepts every search
+        scheduler.submit(engine, limits, 1, [this, gameId, engine] (const GobangSearchResult & result) {
+            {
+                std::lock_guard<std::mutex> lock(doneMutex);
+                done.push_back({ gameId, ChessPosition(result.move.x, result.move.y), engine });
+            }
+            uint64_t one = 1;
+            if (write(completionFd, &one, sizeof(one)) != sizeof(one)) perror("eventfd write failed");
+        });
+        return engine;
+    }
+    // Take the finished searches and return their engines to the free list
+    void collect(std::vector<SearchDone> & results) {
+        {
+            std::lock_guard<std::mutex> lock(doneMutex);
+            results.swap(done);
+        }
+        for (const SearchDone & result : results) idleEngines.push_back(result.engine);
+    }
+};
+
+class GameServer {
+    int epollFd = -1, completionFd = -1, signalFd = -1;
+    int unixListenFd = -1, tcpListenFd = -1;
+    uint64_t nextGameId = FIRST_GAME_ID;
+    std::unordered_map<uint64_t, Game> games;
+    EngineRequest request;
+    SearchPool * pool = nullptr;
+
+    bool watch(int fd, uint64_t id, uint32_t events, int operation = EPOLL_CTL_ADD) {
+        epoll_event event = {};
+        event.events = events;
+        event.data.u64 = id;
+        if (epoll_ctl(epollFd, operation, fd, &event) == -1) {
+            perror("epoll_ctl failed");
+            return false;
+        }
+        return true;
+    }
+    int listenUnix(const std::string & path) {
+        sockaddr_un address = {};
+        if (path.size() >= sizeof(address.sun_path)) {
+            fprintf(stderr, "socket path too long: %s\n", path.c_str());
+            return -1;
+        }
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd == -1) {
+            perror("socket failed");
+            return -1;
+        }
+        address.sun_family = AF_UNIX;
+        memcpy(address.sun_path, path.c_str(), path.size());
+        unlink(path.c_str());
+        if (bind(fd, (sockaddr *) &address, sizeof(address)) == -1 || listen(fd, SOMAXCONN) == -1) {
+            perror("bind/listen failed on unix socket");
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+    int listenTcp(const std::string & host, int port) {
+        sockaddr_in address = {};
+        if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) {
+            fprintf(stderr, "invalid IPv4 address: %s\n", host.c_str());
+            return -1;
+        }
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd == -1) {
+            perror("socket failed");
+            return -1;
+        }
+        int reuse = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        if (bind(fd, (sockaddr *) &address, sizeof(address)) == -1 || listen(fd, SOMAXCONN) == -1) {
+            perror("bind/listen failed on tcp socket");
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    void acceptGames(int listenFd, bool tcp) {
+        while (true) {
+            int fd = accept4(listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd == -1) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) perror("accept failed");
+                return;
+            }
+            if (tcp) {
+                int noDelay = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+            }
+            uint64_t id = nextGameId++;
+            if (!watch(fd, id, EPOLLIN | EPOLLRDHUP)) {
+                close(fd);
+                continue;
+            }
+            games[id].fd = fd;
+        }
+    }
+    void closeGame(uint64_t id) {
+        auto it = games.find(id);
+        if (it == games.end()) return;
+        // A search still running for this game is stopped; it finds no game when it completes and is dropped
+        if (it->second.searching) stopGobangEngine(it->second.engine);
+        close(it->second.fd);
+        games.erase(it);
+    }
+
+    // Returns false if the connection failed
+    bool flush(uint64_t id, Game & game) {
+        while (game.outputOffset < game.output.size()) {
+            ssize_t written = send(game.fd, game.output.data() + game.outputOffset, game.output.size() - game.outputOffset, MSG_NOSIGNAL);
+            if (written == -1) {
+                if (errno == EINTR) continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK) return false;
+                if (game.writable) {
+                    game.writable = false;
+                    return watch(game.fd, id, EPOLLIN | EPOLLRDHUP | EPOLLOUT, EPOLL_CTL_MOD);
+                }
+                return true;
+            }
+            game.outputOffset += written;
+        }
+        game.output.clear();
+        game.outputOffset = 0;
+        if (!game.writable) {
+            game.writable = true;
+            return watch(game.fd, id, EPOLLIN | EPOLLRDHUP, EPOLL_CTL_MOD);
+        }
+        return true;
+    }
+    void respond(Game & game, const EngineResponse & response) {
+        char buffer[256];
+        game.output.append(buffer, writeEngineResponse(response, buffer, sizeof(buffer)));
+    }
+    static bool isOnBoard(const ChessPosition & position) {
+        return position.x >= 0 && position.y >= 0 && position.x < SIZE && position.y < SIZE;
+    }
+
+    // Same board semantics as the keep-running engine: full history replaces the board,
+    // incremental requests apply setup, then the player's move
+    void applyRequest(Game & game) {
+        game.incremental = !request.hasHistory;
+        if (request.hasHistory) {
+            game.board = ChessboardGrid();
+            game.lastMove = ChessPosition(-1, -1);
+            for (int i = 0; i < request.requestCount + request.responseCount; i++) {
+                const ChessPosition & move = i % 2 == 0 ? request.requests[i / 2] : request.responses[i / 2];
+                if (isOnBoard(move)) game.board.set(move.x, move.y, i % 2 == 0 ? PLAYER : BOT);
+            }
+            return;
+        }
+        if (request.hasSetup) {
+            game.board = ChessboardGrid();
+            for (int i = 0; i < request.boardLength; i++) {
+                if (request.board[i] == '0' + BOT) game.board.set(i / SIZE, i % SIZE, BOT);
+                else if (request.board[i] == '0' + PLAYER) game.board.set(i / SIZE, i % SIZE, PLAYER);
+            }
+            game.lastMove = ChessPosition(-1, -1);
+        }
+        // A move on an occupied cell is ignored rather than overwriting the stone
+        if (request.hasMove && isOnBoard(request.move) && game.board.get(request.move.x, request.move.y) == EMPTY) {
+            game.board.set(request.move.x, request.move.y, PLAYER);
+            game.lastMove = request.move;
+        }
+    }
+    // Handle buffered request lines until a search is pending
+    void processLines(uint64_t id, Game & game) {
+        size_t start = 0, newline;
+        while (!game.searching && (newline = game.input.find('\n', start)) != std::string::npos) {
+            parseEngineRequestLine(game.input.data() + start, newline - start, request);
+            start = newline + 1;
+            applyRequest(game);
+            if (request.type == 1) {
+                ChessPiece winner = game.incremental && game.lastMove.x >= 0 ?
+                    judgeWinsAt(game.board, game.lastMove.x, game.lastMove.y) : judgeWinsOnBoard(game.board);
+                EngineResponse response;
+                response.winner = winner;
+                response.prompt = getWinPrompt(winner);
+                respond(game, response);
+                continue;
+            }
+            char board[SIZE * SIZE];
+            for (int i = 0; i < SIZE * SIZE; i++)
+                board[i] = '0' + game.board.get(i / SIZE, i % SIZE);
+            game.engine = pool->submit(id, board);
+            game.searching = true;
+        }
+        game.input.erase(0, start);
+    }
+    // Process what is buffered, flush, and close the game once the peer is done with it
+    void serviceGame(uint64_t id, Game & game) {
+        processLines(id, game);
+        bool finished = game.peerClosed && !game.searching && game.input.find('\n') == std::string::npos;
+        if (!flush(id, game) || (finished && game.output.empty())) closeGame(id);
+    }
+    void readGame(uint64_t id, Game & game) {
+        char buffer[0x1000];
+        while (true) {
+            ssize_t received = recv(game.fd, buffer, sizeof(buffer), 0);
+            if (received > 0) {
+                game.input.append(buffer, received);
+                if (game.input.size() > MAX_BUFFERED_INPUT || (game.input.size() > MAX_REQUEST_LINE && game.input.find('\n') == std::string::npos)) {
+                    closeGame(id);
+                    return;
+                }
+                continue;
+            }
+            if (received == 0) game.peerClosed = true;
+            else if (errno == EINTR) continue;
+            else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                closeGame(id);
+                return;
+            }
+            break;
+        }
+        serviceGame(id, game);
+    }
+    void completeSearches() {
+        uint64_t count;
+        if (read(completionFd, &count, sizeof(count)) == -1 && errno != EAGAIN) perror("eventfd read failed");
+        std::vector<SearchDone> results;
+        pool->collect(results);
+        for (const SearchDone & result : results) {
+            auto it = games.find(result.gameId);
+            if (it == games.end()) continue;
+            Game & game = it->second;
+            game.searching = false;
+            game.engine = nullptr;
+            // Incremental games keep the bot's reply on their board, as the keep-running engine does
+            if (game.incremental && isOnBoard(result.move)) {
+                game.board.set(result.move.x, result.move.y, BOT);
+                game.lastMove = result.move;
+            }
+            EngineResponse response;
+            response.kind = EngineResponseKind::MOVE;
+            response.move = result.move;
+            respond(game, response);
+            serviceGame(result.gameId, game);
+        }
+    }
+
+public:
+    bool start() {
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        completionFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        // Handle SIGINT/SIGTERM in the loop; blocked before the workers start so they inherit the mask
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGINT);
+        sigaddset(&signals, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &signals, NULL);
+        signalFd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+        if (epollFd == -1 || completionFd == -1 || signalFd == -1) {
+            perror("epoll/eventfd/signalfd setup failed");
+            return false;
+        }
+        if (!watch(completionFd, COMPLETION_ID, EPOLLIN) || !watch(signalFd, SIGNAL_ID, EPOLLIN)) return false;
+        if (!config.socketPath.empty()) {
+            if ((unixListenFd = listenUnix(config.socketPath)) == -1 || !watch(unixListenFd, UNIX_LISTENER_ID, EPOLLIN)) return false;
+        }
+        if (config.port) {
+            if ((tcpListenFd = listenTcp(config.host, config.port)) == -1 || !watch(tcpListenFd, TCP_LISTENER_ID, EPOLLIN)) return false;
+        }
+        if (unixListenFd == -1 && tcpListenFd == -1) {
+            fprintf(stderr, "no socket to listen on\n");
+            return false;
+        }
+        pool = new SearchPool(config.workers, completionFd);
+        fprintf(stderr, "gobangServer: unix %s, tcp %s:%d, %d workers, %ums per move, %llu-node slices\n",
+            config.socketPath.empty() ? "-" : config.socketPath.c_str(), config.host.c_str(), config.port, config.workers, config.timeLimitMs, config.sliceNodes);
+        return true;
+    }
+    void run() {
+        epoll_event events[MAX_EPOLL_EVENTS];
+        while (true) {
+            int count = epoll_wait(epollFd, events, MAX_EPOLL_EVENTS, -1);
+            if (count == -1) {
+                if (errno == EINTR) continue;
+                perror("epoll_wait failed");
+                return;
+            }
+            for (int i = 0; i < count; i++) {
+                uint64_t id = events[i].data.u64;
+                if (id == UNIX_LISTENER_ID) acceptGames(unixListenFd, false);
+                else if (id == TCP_LISTENER_ID) acceptGames(tcpListenFd, true);
+                else if (id == COMPLETION_ID) completeSearches();
+                else if (id == SIGNAL_ID) return;
+                else {
+                    auto it = games.find(id);
+                    if (it == games.end()) continue;
+                    if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) readGame(id, it->second);
+                    else serviceGame(id, it->second);
+                }
+            }
+        }
+    }
+    ~GameServer() {
+        delete pool;
+        while (!games.empty()) closeGame(games.begin()->first);
+        if (unixListenFd != -1) {
+            close(unixListenFd);
+            unlink(config.socketPath.c_str());
+        }
+        for (int fd : { tcpListenFd, signalFd, completionFd, epollFd })
+            if (fd != -1) close(fd);
+    }
+};
+
+void init() {
+    char * socketEnv = std::getenv("SERVER_SOCKET");
+    if (socketEnv) config.socketPath = socketEnv;
+    char * hostEnv = std::getenv("SERVER_HOST");
+    if (hostEnv) config.host = hostEnv;
+    char * portEnv = std::getenv("SERVER_PORT");
+    if (portEnv) config.port = std::strtol(portEnv, NULL, 10);
+    char * workersEnv = std::getenv("SERVER_WORKERS");
+    if (workersEnv && std::strtol(workersEnv, NULL, 10) > 0) config.workers = std::strtol(workersEnv, NULL, 10);
+    char * timeoutEnv = std::getenv("TIMEOUT");
+    if (timeoutEnv) config.timeLimitMs = std::strtoul(timeoutEnv, NULL, 10) * 1000;
+    char * sliceNodesEnv = std::getenv("SERVER_SLICE_NODES");
+    if (sliceNodesEnv && std::strtoull(sliceNodesEnv, NULL, 10) > 0) config.sliceNodes = std::strtoull(sliceNodesEnv, NULL, 10);
+    char * nodeQuotaEnv = std::getenv("SERVER_NODE_QUOTA");
+    if (nodeQuotaEnv) config.nodeQuota = std::strtoull(nodeQuotaEnv, NULL, 10);
+    char * tableBitsEnv = std::getenv("SERVER_TABLE_BITS");
+    if (tableBitsEnv) {
+        int tableBits = std::strtol(tableBitsEnv, NULL, 10);
+        if (tableBits >= GOBANG_MIN_TABLE_BITS && tableBits <= GOBANG_MAX_TABLE_BITS) config.tableBits = tableBits;
+    }
+}
+
+int main() {
+    init();
+    GameServer server;
+    if (!server.start()) return 1;
+    server.run();
+    return 0;
+}
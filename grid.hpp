@@ -4,11 +4,14 @@
 #include <cstdint>
 #include <cassert>
 #include <functional>
+#include <type_traits>
 #include "gobang.h"
+#include "bitKernel.hpp"
 
 #define BitsetWithGivenSize std::bitset<BITSET_SIZE>
 
-template <std::size_t BITSET_SIZE>
+// Kernels bound at compile time from build ISA, see bitKernel.hpp
+template <std::size_t BITSET_SIZE, BitKernelISA ISA = BitKernelISA::GENERIC>
 class ChessboardLineBinaryGrid: public BitsetWithGivenSize {
     static_assert(BITSET_SIZE <= sizeof(uint64_t) * 8, 
         "Programmer defined custom operations only support basic integer types!");
@@ -18,15 +21,7 @@ private:
         if (bitsetSize < BITSET_SIZE) *this &= (1ULL << bitsetSize) - 1;
     }
     static uint64_t countOnesForRawValue(uint64_t value, int start = 0, int end = 63) { // [start, end] in range [0, 63]
-        uint64_t mask, result;
-        if (end - start + 1 == 64) mask = -1;
-        else mask = ((1ull << (end - start + 1)) - 1) << start;
-        asm volatile (
-            "popcnt %[maskedValue], %[result]\n"
-            : [result] "=r" (result)
-            : [maskedValue] "r" (value & mask)
-        );
-        return result;
+        return BitKernelOps<ISA>::countOnes(value, start, end);
     }
 public:
     // Initialized with all bits set
@@ -35,6 +30,12 @@ public:
         assert(bitsetSize <= BITSET_SIZE);
         this->set();
     }
+    // Initialized with the given raw value, bits beyond bitsetSize cleared
+    ChessboardLineBinaryGrid(uint64_t bitsetSize, uint64_t value)
+        : BitsetWithGivenSize(value), bitsetSize(bitsetSize) {
+        assert(bitsetSize <= BITSET_SIZE);
+        clearHighBits();
+    }
     void resizeAndSet(uint64_t bitsetSize) {
         assert(bitsetSize <= BITSET_SIZE);
         *const_cast<uint64_t *>(&this->bitsetSize) = bitsetSize;
@@ -94,15 +95,7 @@ public:
         }
         uint64_t value = this->to_ullong();
         uint64_t leftZeroCount, rightZeroCount;
-        asm volatile ( // amd64 architecture
-            "movq %[position], %%rcx\n"
-            "rorq %%cl, %[value]\n"
-            "tzcntq %[value], %[leftZeroCount]\n"
-            "lzcntq %[value], %[rightZeroCount]\n"
-            : [leftZeroCount] "=&r" (leftZeroCount), [rightZeroCount] "=&r" (rightZeroCount)
-            : [value] "r" (value), [position] "rm" (position)
-            : "rcx"
-        );
+        BitKernelOps<ISA>::countZerosAround(value, position, &leftZeroCount, &rightZeroCount);
         if (leftZeroCount == 64 && rightZeroCount == 64) {
             if (leftOnePosition) *leftOnePosition = bitsetSize;
             if (rightOnePosition) *rightOnePosition = -1;
@@ -134,11 +127,7 @@ public:
     uint64_t findFirstZeroAscendingNonRotate(uint64_t position) const {
         uint64_t value = this->to_ullong(), trailingActualOneCount;
         value = ~(value >> position);
-        asm volatile ( // amd64 architecture
-            "tzcntq %[value], %[trailingZeroCount]\n"
-            : [trailingZeroCount] "=r" (trailingActualOneCount)
-            : [value] "r" (value)
-        );
+        trailingActualOneCount = BitKernelOps<ISA>::countTrailingZeros(value);
         position += trailingActualOneCount;
         if (position >= bitsetSize) position = bitsetSize;
         return position;
@@ -157,116 +146,192 @@ public:
 
 #undef BitsetWithGivenSize
 
+constexpr int CHESSBOARD_LINE_COUNT = SIZE + SIZE + DIAGONAL_SIZE + DIAGONAL_SIZE; //棋盘线总数
+constexpr int CHESSBOARD_LINE_TYPE_COUNT = SIZEOF_ENUMCLASS(ChessboardLineType); //棋盘线方向数
+
+// Tables shared by every ChessboardGrid: where each direction starts in the packed line array,
+// how long each line is, and which (line, bit) each cell maps to in every direction.
+struct ChessboardLayout {
+    struct CellLine {
+        uint8_t slot; // Index into the packed line array
+        uint8_t index; // Bit index inside the line, same as ChessboardLine::getIndex
+    };
+    uint8_t offset[CHESSBOARD_LINE_TYPE_COUNT];
+    uint8_t lineSize[CHESSBOARD_LINE_COUNT];
+    CellLine cellLines[SIZE][SIZE][CHESSBOARD_LINE_TYPE_COUNT];
+    constexpr ChessboardLayout(): offset(), lineSize(), cellLines() {
+        offset[C2MI(ChessboardLineType::LINE)] = 0;
+        offset[C2MI(ChessboardLineType::ROW)] = SIZE;
+        offset[C2MI(ChessboardLineType::ULLRDiagonal)] = SIZE + SIZE;
+        offset[C2MI(ChessboardLineType::LLURDiagonal)] = SIZE + SIZE + DIAGONAL_SIZE;
+        for (int i = 0; i < SIZE; i++) {
+            lineSize[offset[C2MI(ChessboardLineType::LINE)] + i] = SIZE;
+            lineSize[offset[C2MI(ChessboardLineType::ROW)] + i] = SIZE;
+        }
+        for (int i = 0; i < DIAGONAL_SIZE; i++) {
+            lineSize[offset[C2MI(ChessboardLineType::ULLRDiagonal)] + i] = i < SIZE ? i + 1 : DIAGONAL_SIZE - i;
+            lineSize[offset[C2MI(ChessboardLineType::LLURDiagonal)] + i] = i < SIZE ? i + 1 : DIAGONAL_SIZE - i;
+        }
+        for (int x = 0; x < SIZE; x++) {
+            for (int y = 0; y < SIZE; y++) {
+                int ullrShift = std::min(x, y), llurShift = std::min(SIZE - 1 - x, y);
+                int ullrID = x == ullrShift ? SIZE - 1 - (y - ullrShift) : SIZE - 1 + (x - ullrShift);
+                cellLines[x][y][C2MI(ChessboardLineType::LINE)] = {
+                    uint8_t(offset[C2MI(ChessboardLineType::LINE)] + x), uint8_t(y) };
+                cellLines[x][y][C2MI(ChessboardLineType::ROW)] = {
+                    uint8_t(offset[C2MI(ChessboardLineType::ROW)] + y), uint8_t(x) };
+                cellLines[x][y][C2MI(ChessboardLineType::ULLRDiagonal)] = {
+                    uint8_t(offset[C2MI(ChessboardLineType::ULLRDiagonal)] + ullrID), uint8_t(ullrShift) };
+                cellLines[x][y][C2MI(ChessboardLineType::LLURDiagonal)] = {
+                    uint8_t(offset[C2MI(ChessboardLineType::LLURDiagonal)] + x + y), uint8_t(llurShift) };
+            }
+        }
+    }
+    int getSlot(const ChessboardLine & line) const {
+        return offset[C2MI(line.getType())] + line.getUniqueID();
+    }
+};
+
+inline constexpr ChessboardLayout chessboardLayout;
+
 class ChessboardGrid {
 private:
     /*
-        grids[EMPTY][*][*] for Both Player & Bot chesses' occupation;
-        grids[BOT][*][*] for Bot chesses' occupation;
-        grids[PLAYER][*][*] for Player chesses' occupation.
-        grids[*][LINE][i] for line occupation, i_{max} = 14, size of the third dimension is 15.
-        grids[*][ROW][i] for row occupation, i_{max} = 14, size of the third dimension is 15.
-        grids[*][ULLRDiagonal][i] for line occupation, i_{max} = 28, size of the third dimension is 29.
-        grids[*][LLURDiagonal][i] for line occupation, i_{max} = 28, size of the third dimension is 29.
+        Packed layout, two 16-bit masks per line:
+        masks[slot][BOT - PIECE_START] for Bot chesses' occupation;
+        masks[slot][PLAYER - PIECE_START] for Player chesses' occupation.
+        Slots are grouped by direction: LINE (15), ROW (15), ULLRDiagonal (29), LLURDiagonal (29),
+        starting at chessboardLayout.offset[type]; line lengths live in chessboardLayout.lineSize.
+        Occupation of both Player & Bot chesses (EMPTY) is derived from BOT | PLAYER.
 
-        0 is placed, 1 is unplaced.
+        1 is placed, 0 is unplaced.
     */
 
-    ChessboardLineBinaryGrid<SIZE> grids[PIECE_END + 1][SIZEOF_ENUMCLASS(ChessboardLineType)][DIAGONAL_SIZE];
-public:
-    ChessboardGrid() {
-        for (int k = EMPTY; k <= PIECE_END; k++) {
-            for (int i = 0; i < SIZE; i++) {
-                grids[k][C2MI(ChessboardLineType::ULLRDiagonal)][i].resizeAndSet(i + 1);
-                grids[k][C2MI(ChessboardLineType::ULLRDiagonal)][DIAGONAL_SIZE - 1 - i].resizeAndSet(i + 1);
-                grids[k][C2MI(ChessboardLineType::LLURDiagonal)][i].resizeAndSet(i + 1);
-                grids[k][C2MI(ChessboardLineType::LLURDiagonal)][DIAGONAL_SIZE - 1 - i].resizeAndSet(i + 1);
-            }
-        }
+    alignas(64) uint16_t masks[CHESSBOARD_LINE_COUNT][PIECE_END];
+
+    uint64_t getOccupation(ChessPiece piece, int slot) const {
+        if (piece == EMPTY) return masks[slot][BOT - PIECE_START] | masks[slot][PLAYER - PIECE_START];
+        return masks[slot][piece - PIECE_START];
+    }
+    // Line view in ChessboardLineBinaryGrid convention: 0 is placed, 1 is unplaced
+    template <BitKernelISA ISA>
+    ChessboardLineBinaryGrid<SIZE, ISA> getLineGrid(ChessPiece piece, int slot) const {
+        return ChessboardLineBinaryGrid<SIZE, ISA>(chessboardLayout.lineSize[slot], ~getOccupation(piece, slot));
     }
+public:
+    ChessboardGrid(): masks() {}
     ChessPiece get(uint64_t x, uint64_t y) const {
         assert(x < SIZE && y < SIZE);
-        if (!grids[BOT][C2MI(ChessboardLineType::LINE)][x][y]) return BOT;
-        else if (!grids[PLAYER][C2MI(ChessboardLineType::LINE)][x][y]) return PLAYER;
+        const ChessboardLayout::CellLine & cell = chessboardLayout.cellLines[x][y][C2MI(ChessboardLineType::LINE)];
+        if (masks[cell.slot][BOT - PIECE_START] >> cell.index & 1) return BOT;
+        else if (masks[cell.slot][PLAYER - PIECE_START] >> cell.index & 1) return PLAYER;
         else return EMPTY;
     }
     void set(int x, int y, ChessPiece value) {
-        constexpr int ChessboardLineCount = 4;
-		ChessboardLine ChessboardLineArr[ChessboardLineCount] = {
-			ChessboardLine(ChessboardLineType::LINE, x, 0), // 行
-			ChessboardLine(ChessboardLineType::ROW, 0, y), // 列
-			ChessboardLine(ChessboardLineType::ULLRDiagonal, x, y), // 左上-右下对角线
-			ChessboardLine(ChessboardLineType::LLURDiagonal, x, y) // 右上-左下对角线
-		};
-        switch (value) {
-            case EMPTY: {
-                for (int i = 0; i < ChessboardLineCount; i++) {
-                    grids[EMPTY][C2MI(ChessboardLineArr[i].getType())][ChessboardLineArr[i].getUniqueID()]
-                        .set(ChessboardLineArr[i].getIndex(x, y));
-                    grids[BOT][C2MI(ChessboardLineArr[i].getType())][ChessboardLineArr[i].getUniqueID()]
-                        .set(ChessboardLineArr[i].getIndex(x, y));
-                    grids[PLAYER][C2MI(ChessboardLineArr[i].getType())][ChessboardLineArr[i].getUniqueID()]
-                        .set(ChessboardLineArr[i].getIndex(x, y));
-                }
-                break;
-            }
-            case BOT: {
-                for (int i = 0; i < ChessboardLineCount; i++) {
-                    grids[EMPTY][C2MI(ChessboardLineArr[i].getType())][ChessboardLineArr[i].getUniqueID()]
-                        .reset(ChessboardLineArr[i].getIndex(x, y));
-                    grids[BOT][C2MI(ChessboardLineArr[i].getType())][ChessboardLineArr[i].getUniqueID()]
-                        .reset(ChessboardLineArr[i].getIndex(x, y));
-                    grids[PLAYER][C2MI(ChessboardLineArr[i].getType())][ChessboardLineArr[i].getUniqueID()]
-                        .set(ChessboardLineArr[i].getIndex(x, y));
-                }
-                break;
-            }
-            case PLAYER: {
-                for (int i = 0; i < ChessboardLineCount; i++) {
-                    grids[EMPTY][C2MI(ChessboardLineArr[i].getType())][ChessboardLineArr[i].getUniqueID()]
-                        .reset(ChessboardLineArr[i].getIndex(x, y));
-                    grids[BOT][C2MI(ChessboardLineArr[i].getType())][ChessboardLineArr[i].getUniqueID()]
-                        .set(ChessboardLineArr[i].getIndex(x, y));
-                    grids[PLAYER][C2MI(ChessboardLineArr[i].getType())][ChessboardLineArr[i].getUniqueID()]
-                        .reset(ChessboardLineArr[i].getIndex(x, y));
-                }
-                break;
-            }
-            default:
-                break;
+        assert(x >= 0 && y >= 0 && x < SIZE && y < SIZE);
+        if (value != EMPTY && value != BOT && value != PLAYER) return;
+        for (int k = 0; k < CHESSBOARD_LINE_TYPE_COUNT; k++) {
+            const ChessboardLayout::CellLine & cell = chessboardLayout.cellLines[x][y][k];
+            uint16_t bit = 1u << cell.index;
+            masks[cell.slot][BOT - PIECE_START] &= ~bit;
+            masks[cell.slot][PLAYER - PIECE_START] &= ~bit;
+            if (value != EMPTY) masks[cell.slot][value - PIECE_START] |= bit;
+        }
+    }
+    // Raw occupation mask of piece (BOT or PLAYER) on line slot, 1 is placed
+    uint16_t getLineMask(ChessPiece piece, int slot) const {
+        assert(piece == BOT || piece == PLAYER);
+        return masks[slot][piece - PIECE_START];
+    }
+    // Number of placed chesses of both sides
+    template <BitKernelISA ISA = BitKernelISA::GENERIC>
+    uint64_t countPieces() const {
+        uint64_t count = 0;
+        for (int x = 0; x < SIZE; x++) {
+            int slot = chessboardLayout.cellLines[x][0][C2MI(ChessboardLineType::LINE)].slot;
+            count += BitKernelOps<ISA>::countOnes(getOccupation(EMPTY, slot), 0, 63);
+        }
+        return count;
+    }
+    // Whether an occupation mask (1 is placed) holds five or more contiguous placed bits
+    static bool hasFiveInMask(uint64_t mask) {
+        return mask & mask >> 1 & mask >> 2 & mask >> 3 & mask >> 4;
+    }
+    // Five-in-a-row check for piece on the four lines through (x, y), e.g. right after a move there
+    bool isFiveAt(ChessPiece piece, int x, int y) const {
+        assert(piece == BOT || piece == PLAYER);
+        for (int k = 0; k < CHESSBOARD_LINE_TYPE_COUNT; k++) {
+            if (hasFiveInMask(masks[chessboardLayout.cellLines[x][y][k].slot][piece - PIECE_START]))
+                return true;
+        }
+        return false;
+    }
+    // Stateless sweep over every line, returns the piece having five in a row, EMPTY if none
+    ChessPiece findFive() const {
+        for (int slot = 0; slot < CHESSBOARD_LINE_COUNT; slot++) {
+            if (hasFiveInMask(masks[slot][BOT - PIECE_START])) return BOT;
+            if (hasFiveInMask(masks[slot][PLAYER - PIECE_START])) return PLAYER;
+        }
+        return EMPTY;
+    }
+    // Same traversal as lambdaForTraverseChessboardLine, but over raw occupation masks (1 is placed),
+    // so callers can evaluate hypothetical lines without touching the board.
+    template <BitKernelISA ISA = BitKernelISA::GENERIC, typename Lambda>
+    static void lambdaForTraverseLineMasks(uint64_t botMask, uint64_t playerMask, uint64_t bitsetSize, Lambda && lambda) {
+        // void lambda(ChessPiece currentPiece, int count, int position, ChessPiece leftOutOfBoundPiece, ChessPiece rightOutOfBoundPiece);
+        auto getPieceInMasks = [&] (uint64_t pos) {
+            if (pos >= bitsetSize) return NOT_EXIST;
+            else if (botMask >> pos & 1) return BOT;
+            else if (playerMask >> pos & 1) return PLAYER;
+            else return EMPTY;
+        };
+        uint64_t occupation = botMask | playerMask;
+        while (occupation) {
+            uint64_t i = BitKernelOps<ISA>::countTrailingZeros(occupation);
+            ChessPiece currentPiece = botMask >> i & 1 ? BOT : PLAYER;
+            uint64_t currentMask = currentPiece == BOT ? botMask : playerMask;
+            uint64_t contiguousChessCount = BitKernelOps<ISA>::countTrailingZeros(~(currentMask >> i));
+            uint64_t leftOnePosition = i + contiguousChessCount;
+            lambda(currentPiece, contiguousChessCount, i, getPieceInMasks(leftOnePosition), i ? getPieceInMasks(i - 1) : NOT_EXIST);
+            occupation &= ~0ull << leftOnePosition;
         }
     }
-    void lambdaForTraverseChessboardLine(ChessboardLine &line, std::function<void (ChessPiece, int, int, ChessPiece, ChessPiece)> const & lambda) {
+    template <BitKernelISA ISA = BitKernelISA::GENERIC>
+    void lambdaForTraverseChessboardLine(ChessboardLine &line, std::function<void (ChessPiece, int, int, ChessPiece, ChessPiece)> const & lambda) const {
         // void lambda(ChessPiece currentPiece, int count, int position, ChessPiece leftOutOfBoundPiece, ChessPiece rightOutOfBoundPiece);
-        int lineTypedIndex = C2MI(line.getType());
-        uint64_t uniqueID = line.getUniqueID();
-        uint64_t bitsetSize = line.size();
-        auto &emptyGrids = grids[EMPTY][lineTypedIndex][uniqueID], &botGrids = grids[BOT][lineTypedIndex][uniqueID], &playerGrids = grids[PLAYER][lineTypedIndex][uniqueID];
+        int slot = chessboardLayout.getSlot(line);
+        uint64_t bitsetSize = chessboardLayout.lineSize[slot];
+        ChessboardLineBinaryGrid<SIZE, ISA> pieceGrids[PIECE_END + 1] = {
+            getLineGrid<ISA>(EMPTY, slot), getLineGrid<ISA>(BOT, slot), getLineGrid<ISA>(PLAYER, slot)
+        };
+        auto &emptyGrids = pieceGrids[EMPTY];
         auto getPleceInChessboardLine = [&] (int pos) {
-                if (!grids[BOT][lineTypedIndex][uniqueID][pos]) return BOT;
-                else if (!grids[PLAYER][lineTypedIndex][uniqueID][pos]) return PLAYER;
+                if (!pieceGrids[BOT][pos]) return BOT;
+                else if (!pieceGrids[PLAYER][pos]) return PLAYER;
                 else return EMPTY;
         };
         for (uint64_t i = emptyGrids.findFirstZeroAscendingNonRotate(0); i < bitsetSize; i = emptyGrids.findFirstZeroAscendingNonRotate(i)) {
             ChessPiece currentPiece = getPleceInChessboardLine(i);
             uint64_t contiguousChessCount, leftOnePosition, rightOnePosition;
-            contiguousChessCount = grids[currentPiece][lineTypedIndex][uniqueID].getContiguousZeroCountNonRotate(i, &leftOnePosition, &rightOnePosition);
+            contiguousChessCount = pieceGrids[currentPiece].getContiguousZeroCountNonRotate(i, &leftOnePosition, &rightOnePosition);
             ChessPiece leftOutOfBoundPiece, rightOutOfBoundPiece;
             if (leftOnePosition == bitsetSize) leftOutOfBoundPiece = NOT_EXIST;
             else leftOutOfBoundPiece = getPleceInChessboardLine(leftOnePosition);
-            if (rightOnePosition == -1) rightOnePosition = NOT_EXIST;
+            if (rightOnePosition == (uint64_t) -1) rightOutOfBoundPiece = NOT_EXIST;
             else rightOutOfBoundPiece = getPleceInChessboardLine(rightOnePosition);
             lambda(currentPiece, contiguousChessCount, i, leftOutOfBoundPiece, rightOutOfBoundPiece);
             i = leftOnePosition;
         }
     }
-    void getSingleChessChainStatus(SingleChessChainStatus & status) {
+    template <BitKernelISA ISA = BitKernelISA::GENERIC>
+    void getSingleChessChainStatus(SingleChessChainStatus & status) const {
         assert(status.chessType == BOT || status.chessType == PLAYER);
         assert(this->get(status.dropPosition.x, status.dropPosition.y) != ChessPieceAdversaryMapper[status.chessType]);
-        uint64_t lineUniqueID = status.chessboardLine.getUniqueID();
+        int slot = chessboardLayout.getSlot(status.chessboardLine);
         uint64_t chessIndex = status.chessboardLine.getIndex(status.dropPosition.x, status.dropPosition.y);
-        auto &emptyGrids = grids[EMPTY][C2MI(status.lineType)][lineUniqueID],
-            &selfGrids = grids[status.chessType][C2MI(status.lineType)][lineUniqueID],
-            &adversaryGrids = grids[ChessPieceAdversaryMapper[status.chessType]][C2MI(status.lineType)][lineUniqueID];
+        ChessboardLineBinaryGrid<SIZE, ISA> emptyGrids = getLineGrid<ISA>(EMPTY, slot),
+            selfGrids = getLineGrid<ISA>(status.chessType, slot),
+            adversaryGrids = getLineGrid<ISA>(ChessPieceAdversaryMapper[status.chessType], slot);
         adversaryGrids.getContiguousOneCountNonRotate(chessIndex,
             reinterpret_cast<uint64_t *>(&status.adversaryLeftAdjacentIndex),
             reinterpret_cast<uint64_t *>(&status.adversaryRightAdjacentIndex)
@@ -279,3 +344,6 @@ public:
         status.selfChessCount = selfGrids.countZeros(status.selfRightmostIndex, status.selfLeftmostIndex);
     }
 };
+
+static_assert(sizeof(ChessboardGrid) <= 6 * 64, "ChessboardGrid should stay within a few cache lines");
+static_assert(std::is_trivially_copyable<ChessboardGrid>::value, "ChessboardGrid is copied per search thread");
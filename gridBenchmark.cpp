@@ -0,0 +1,278 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include "gobang.h"
+#include "grid.hpp"
+#include "gobangSearch.hpp"
+#include "gobangEngine.h"
+
+#ifdef BIT_KERNEL_X86
+#include <x86intrin.h>
+#endif
+
+/*
+    Microbenchmarks of the board kernels on randomised realistic boards.
+
+    Usage: gridBenchmark [samples] [filter]
+    Every benchmark runs once per bit-kernel build the CPU supports (see bitKernel.hpp), so the
+    builds are compared side by side; the mask traversal and the uncached move evaluation are
+    listed next to the kernels they can replace. Benchmarks whose name does not contain filter are
+    skipped.
+
+    A sample times OPS_PER_SAMPLE operations over inputs drawn from boards grown by random moves
+    next to existing stones (8 to 80 stones). WARMUP_SAMPLES untimed samples come first. The
+    report gives the median, the mean with a 95% confidence interval (normal approximation over
+    the samples) and the minimum, in cycles per operation. On x86 cycles are TSC reference cycles,
+    which run at a fixed rate regardless of turbo; elsewhere they are nanoseconds. Pin the process
+    (taskset) and keep the machine quiet for stable numbers.
+*/
+
+constexpr int OPS_PER_SAMPLE = 1 << 14;
+constexpr int WARMUP_SAMPLES = 5;
+constexpr int BOARD_COUNT = 64;
+constexpr int INPUT_COUNT = 1 << 12; // Power of two, inputs are indexed modulo it
+
+// Keeps a value alive without letting the compiler see through it
+template <typename T>
+inline void doNotOptimize(const T & value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline uint64_t readCycles() {
+#ifdef BIT_KERNEL_X86
+    _mm_lfence();
+    uint64_t cycles = __rdtsc();
+    _mm_lfence();
+    return cycles;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+struct BenchmarkStats {
+    double median, mean, confidence, min;
+};
+
+// body(isa, i) performs operation i with the kernels of build isa; returns cycles per operation over the samples
+BenchmarkStats measure(int samples, BitKernelISA isa, const std::function<void (BitKernelISA, int)> & body) {
+    auto runSample = [&] {
+        uint64_t start = readCycles();
+        for (int i = 0; i < OPS_PER_SAMPLE; i++) body(isa, i);
+        return (double) (readCycles() - start) / OPS_PER_SAMPLE;
+    };
+    for (int i = 0; i < WARMUP_SAMPLES; i++) runSample();
+    std::vector<double> perOp;
+    for (int i = 0; i < samples; i++) perOp.push_back(runSample());
+    std::sort(perOp.begin(), perOp.end());
+    double sum = 0, squares = 0;
+    for (double value : perOp) sum += value;
+    double mean = sum / samples;
+    for (double value : perOp) squares += (value - mean) * (value - mean);
+    double deviation = samples > 1 ? std::sqrt(squares / (samples - 1)) : 0;
+    return { perOp[samples / 2], mean, 1.96 * deviation / std::sqrt((double) samples), perOp.front() };
+}
+
+struct LineInput {
+    uint64_t size, value; // One piece's (or EMPTY's) line view: 0 is placed
+    uint64_t position;
+};
+struct CellInput {
+    int board, x, y;
+    ChessPiece piece;
+};
+struct TraverseInput {
+    int board;
+    ChessboardLine line;
+    uint64_t botMask, playerMask, size;
+};
+
+std::vector<ChessboardGrid> boards;
+std::vector<LineInput> lineInputs;
+std::vector<CellInput> cellInputs, emptyCellInputs; // emptyCellInputs are empty cells next to stones
+std::vector<TraverseInput> traverseInputs;
+
+void generateInputs() {
+    std::mt19937_64 generator(0x6772696442656E63ull);
+    for (int b = 0; b < BOARD_COUNT; b++) {
+        ChessboardGrid board;
+        int stones = 8 + generator() % 73;
+        board.set(SIZE / 2, SIZE / 2, BOT);
+        for (int s = 1; s < stones; s++) {
+            std::vector<ChessPosition> candidates;
+            for (int i = 0; i < SIZE; i++)
+                for (int j = 0; j < SIZE; j++) {
+                    if (board.get(i, j) != EMPTY) continue;
+                    bool adjacent = false;
+                    for (int dx = -1; dx <= 1 && !adjacent; dx++)
+                        for (int dy = -1; dy <= 1 && !adjacent; dy++)
+                            adjacent = i + dx >= 0 && j + dy >= 0 && i + dx < SIZE && j + dy < SIZE && board.get(i + dx, j + dy) != EMPTY;
+                    if (adjacent) candidates.emplace_back(i, j);
+                }
+            ChessPosition move = candidates[generator() % candidates.size()];
+            board.set(move.x, move.y, s % 2 ? PLAYER : BOT);
+        }
+        boards.push_back(board);
+    }
+    while (lineInputs.size() < INPUT_COUNT) {
+        const ChessboardGrid & board = boards[generator() % BOARD_COUNT];
+        int slot = generator() % CHESSBOARD_LINE_COUNT;
+        uint64_t size = chessboardLayout.lineSize[slot];
+        if (size < 5) continue; // Too short to hold a five, never evaluated in practice
+        uint64_t bot = board.getLineMask(BOT, slot), player = board.getLineMask(PLAYER, slot);
+        uint64_t occupation[] = { bot | player, bot, player };
+        lineInputs.push_back({ size, ~occupation[generator() % 3], generator() % size });
+    }
+    while (cellInputs.size() < INPUT_COUNT || emptyCellInputs.size() < INPUT_COUNT) {
+        int b = generator() % BOARD_COUNT, x = generator() % SIZE, y = generator() % SIZE;
+        ChessPiece piece = generator() % 2 ? BOT : PLAYER;
+        if (cellInputs.size() < INPUT_COUNT) cellInputs.push_back({ b, x, y, piece });
+        bool adjacent = false;
+        for (int dx = -1; dx <= 1 && !adjacent; dx++)
+            for (int dy = -1; dy <= 1 && !adjacent; dy++)
+                adjacent = x + dx >= 0 && y + dy >= 0 && x + dx < SIZE && y + dy < SIZE && boards[b].get(x + dx, y + dy) != EMPTY;
+        if (adjacent && boards[b].get(x, y) == EMPTY && emptyCellInputs.size() < INPUT_COUNT)
+            emptyCellInputs.push_back({ b, x, y, piece });
+    }
+    for (int i = 0; i < INPUT_COUNT; i++) {
+        const CellInput & cell = cellInputs[i];
+        ChessboardLineType type = static_cast<ChessboardLineType>(generator() % CHESSBOARD_LINE_TYPE_COUNT);
+        ChessboardLine line(type, cell.x, cell.y);
+        int slot = chessboardLayout.getSlot(line);
+        traverseInputs.push_back({ cell.board, line, boards[cell.board].getLineMask(BOT, slot),
+            boards[cell.board].getLineMask(PLAYER, slot), chessboardLayout.lineSize[slot] });
+    }
+}
+
+struct Benchmark {
+    const char * name;
+    bool usesBitKernel; // Repeated for every bit-kernel build
+    std::function<void (BitKernelISA, int)> body;
+};
+
+// Body running op(kernel, i) with the kernels of the requested build bound at compile time, entered
+// per operation through dispatchBitKernel as the search enters its slices
+template <typename Op>
+std::function<void (BitKernelISA, int)> perKernel(Op op) {
+    return [op] (BitKernelISA isa, int i) {
+        dispatchBitKernel(isa, [&] (auto kernel) { op(kernel, i); });
+    };
+}
+
+int main(int argc, char ** argv) {
+    int samples = argc > 1 ? atoi(argv[1]) : 30;
+    const char * filter = argc > 2 ? argv[2] : "";
+    if (samples <= 0) return 1;
+    generateInputs();
+
+    // One search object per board for the evaluation benchmarks, with a minimal transposition table
+    std::vector<std::unique_ptr<Gobang>> positions;
+    for (const ChessboardGrid & board : boards) {
+        positions.emplace_back(new Gobang(GOBANG_MIN_TABLE_BITS));
+        for (int x = 0; x < SIZE; x++)
+            for (int y = 0; y < SIZE; y++)
+                if (board.get(x, y) != EMPTY) positions.back()->placeAt(x, y, board.get(x, y));
+    }
+    ChessboardGrid scratch = boards[0];
+    long long traverseSum = 0;
+    auto traverseLambda = [&] (ChessPiece piece, int count, int position, ChessPiece left, ChessPiece right) {
+        traverseSum += piece * 7 + count * 3 + position + left - right;
+    };
+    const int mask = INPUT_COUNT - 1;
+
+    std::vector<Benchmark> benchmarks = {
+        { "getContiguousZeroCount", true, perKernel([&] (auto kernel, int i) {
+            uint64_t left, right;
+            const LineInput & input = lineInputs[i & mask];
+            ChessboardLineBinaryGrid<SIZE, decltype(kernel)::value> grid(input.size, input.value);
+            doNotOptimize(grid.getContiguousZeroCount(input.position, &left, &right));
+            doNotOptimize(left);
+        }) },
+        { "getContiguousOneCountNonRotate", true, perKernel([&] (auto kernel, int i) {
+            uint64_t left, right;
+            const LineInput & input = lineInputs[i & mask];
+            ChessboardLineBinaryGrid<SIZE, decltype(kernel)::value> grid(input.size, input.value);
+            doNotOptimize(grid.getContiguousOneCountNonRotate(input.position, &left, &right));
+            doNotOptimize(left);
+        }) },
+        { "findFirstZeroAscendingNonRotate", true, perKernel([&] (auto kernel, int i) {
+            const LineInput & input = lineInputs[i & mask];
+            ChessboardLineBinaryGrid<SIZE, decltype(kernel)::value> grid(input.size, input.value);
+            doNotOptimize(grid.findFirstZeroAscendingNonRotate(input.position));
+        }) },
+        { "ChessboardGrid::get", false, [&] (BitKernelISA, int i) {
+            const CellInput & cell = cellInputs[i & mask];
+            doNotOptimize(boards[cell.board].get(cell.x, cell.y));
+        } },
+        { "ChessboardGrid::set", false, [&] (BitKernelISA, int i) {
+            const CellInput & cell = cellInputs[i & mask];
+            scratch.set(cell.x, cell.y, i & 4 ? EMPTY : cell.piece);
+            doNotOptimize(scratch);
+        } },
+        { "lambdaForTraverseChessboardLine", true, perKernel([&] (auto kernel, int i) {
+            TraverseInput & input = traverseInputs[i & mask];
+            boards[input.board].lambdaForTraverseChessboardLine<decltype(kernel)::value>(input.line, traverseLambda);
+            doNotOptimize(traverseSum);
+        }) },
+        { "  alternative: lambdaForTraverseLineMasks", true, perKernel([&] (auto kernel, int i) {
+            const TraverseInput & input = traverseInputs[i & mask];
+            ChessboardGrid::lambdaForTraverseLineMasks<decltype(kernel)::value>(input.botMask, input.playerMask, input.size, traverseLambda);
+            doNotOptimize(traverseSum);
+        }) },
+        { "EvaluateUnit", true, perKernel([&] (auto kernel, int i) {
+            const CellInput & cell = cellInputs[i & mask];
+            doNotOptimize(positions[cell.board]->EvaluateUnit<decltype(kernel)::value>(cell.x, cell.y));
+        }) },
+        { "EvaluateUnitDiff (memo miss)", true, perKernel([&] (auto kernel, int i) {
+            const CellInput & cell = emptyCellInputs[i & mask];
+            positions[cell.board]->invalidateUnitDiff(cell.x, cell.y);
+            doNotOptimize(positions[cell.board]->EvaluateUnitDiff<decltype(kernel)::value>(cell.piece, cell.x, cell.y));
+        }) },
+        { "EvaluateUnitDiff (memo hit)", true, perKernel([&] (auto kernel, int i) {
+            const CellInput & cell = emptyCellInputs[i & mask];
+            doNotOptimize(positions[cell.board]->EvaluateUnitDiff<decltype(kernel)::value>(cell.piece, cell.x, cell.y));
+        }) },
+        { "  alternative: EvaluateMoveDelta", true, perKernel([&] (auto kernel, int i) {
+            const CellInput & cell = emptyCellInputs[i & mask];
+            doNotOptimize(positions[cell.board]->EvaluateMoveDelta<decltype(kernel)::value>(cell.piece, cell.x, cell.y));
+        }) },
+    };
+
+    std::vector<BitKernelISA> kernels;
+    for (int isa = C2MI(BitKernelISA::GENERIC); isa < C2MI(BitKernelISA::SIZE); isa++)
+        if (isBitKernelISASupported(static_cast<BitKernelISA>(isa))) kernels.push_back(static_cast<BitKernelISA>(isa));
+
+#ifdef BIT_KERNEL_X86
+    const char * unit = "TSC cycles";
+    uint64_t cyclesStart = readCycles();
+    auto clockStart = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - clockStart < std::chrono::milliseconds(100));
+    double nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - clockStart).count();
+    printf("TSC %.3f GHz, ", (readCycles() - cyclesStart) / nanoseconds);
+#else
+    const char * unit = "ns";
+#endif
+    printf("%d samples of %d operations after %d warmup samples, %s per operation, default bit kernel %s\n",
+        samples, OPS_PER_SAMPLE, WARMUP_SAMPLES, unit, BitKernelTable[C2MI(activeBitKernelISA)].name);
+    // Every operation goes through a std::function call and the bit-kernel dispatch, included in the figures below
+    BenchmarkStats overhead = measure(samples, activeBitKernelISA, perKernel([] (auto, int i) { doNotOptimize(i); }));
+    printf("harness overhead %.2f per operation, included below\n\n", overhead.median);
+    printf("%-42s %-8s %10s %10s %9s %10s\n", "benchmark", "kernel", "median", "mean", "+-95%", "min");
+    for (const Benchmark & benchmark : benchmarks) {
+        if (!strstr(benchmark.name, filter)) continue;
+        for (BitKernelISA isa : kernels) {
+            if (!benchmark.usesBitKernel && isa != kernels.back()) continue;
+            BenchmarkStats stats = measure(samples, isa, benchmark.body);
+            printf("%-42s %-8s %10.2f %10.2f %9.2f %10.2f\n", benchmark.name,
+                benchmark.usesBitKernel ? BitKernelTable[C2MI(isa)].name : "-", stats.median, stats.mean, stats.confidence, stats.min);
+        }
+    }
+    return 0;
+}
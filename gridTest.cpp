@@ -1,7 +1,26 @@
 #include <cstdio>
 #include <cstdint>
+#include <cstring>
 #include <cassert>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <sys/wait.h>
 #include "grid.hpp"
+#include "engineProtocol.hpp"
+#include "gobangEngine.h"
+#include "gobangSearch.hpp"
+#include "searchScheduler.hpp"
+#include "gameStore.hpp"
+#include "arenaStats.hpp"
+#include "exec.h"
 
 using namespace std;
 
@@ -201,6 +220,495 @@ void testGetSingleChessChainStatus4() {
         status.adversaryRightAdjacentIndex == 0 && status.adversaryLeftAdjacentIndex == 8);
 }
 
+void testChessboardLayout() {
+    constexpr ChessboardLineType types[CHESSBOARD_LINE_TYPE_COUNT] = {
+        ChessboardLineType::LINE, ChessboardLineType::ROW, ChessboardLineType::ULLRDiagonal, ChessboardLineType::LLURDiagonal
+    };
+    for (int x = 0; x < SIZE; x++) {
+        for (int y = 0; y < SIZE; y++) {
+            for (int k = 0; k < CHESSBOARD_LINE_TYPE_COUNT; k++) {
+                ChessboardLine line(types[k], x, y);
+                const ChessboardLayout::CellLine & cell = chessboardLayout.cellLines[x][y][k];
+                assert(cell.slot == chessboardLayout.getSlot(line));
+                assert(cell.index == line.getIndex(x, y));
+                assert(chessboardLayout.lineSize[cell.slot] == line.size());
+            }
+        }
+    }
+
+    ChessboardGrid grid;
+    grid.set(3, 4, BOT);
+    grid.set(14, 0, PLAYER);
+    grid.set(7, 7, PLAYER);
+    grid.set(7, 7, EMPTY);
+    ChessboardGrid copy = grid;
+    printf("%zu\n", sizeof(ChessboardGrid));
+    assert(copy.get(3, 4) == BOT && copy.get(14, 0) == PLAYER && copy.get(7, 7) == EMPTY && copy.get(0, 0) == EMPTY);
+}
+
+void testTraverseLineMasks() {
+    constexpr ChessboardLineType types[CHESSBOARD_LINE_TYPE_COUNT] = {
+        ChessboardLineType::LINE, ChessboardLineType::ROW, ChessboardLineType::ULLRDiagonal, ChessboardLineType::LLURDiagonal
+    };
+    uint64_t seed = 0x2545F4914F6CDD1Dull;
+    for (int round = 0; round < 64; round++) {
+        ChessboardGrid grid;
+        for (int x = 0; x < SIZE; x++) {
+            for (int y = 0; y < SIZE; y++) {
+                seed ^= seed << 13;
+                seed ^= seed >> 7;
+                seed ^= seed << 17;
+                grid.set(x, y, static_cast<ChessPiece>(seed % (round % 4 + 3) % 3));
+            }
+        }
+        for (int x = 0; x < SIZE; x++) {
+            for (int y = 0; y < SIZE; y++) {
+                for (int k = 0; k < CHESSBOARD_LINE_TYPE_COUNT; k++) {
+                    ChessboardLine line(types[k], x, y);
+                    int slot = chessboardLayout.getSlot(line);
+                    std::vector<int> viewRuns, maskRuns;
+                    auto record = [] (std::vector<int> & runs) {
+                        return [&runs] (ChessPiece currentPiece, int count, int position, ChessPiece leftOutOfBoundPiece, ChessPiece rightOutOfBoundPiece) {
+                            runs.insert(runs.end(), { currentPiece, count, position, leftOutOfBoundPiece, rightOutOfBoundPiece });
+                        };
+                    };
+                    grid.lambdaForTraverseChessboardLine(line, record(viewRuns));
+                    ChessboardGrid::lambdaForTraverseLineMasks(grid.getLineMask(BOT, slot), grid.getLineMask(PLAYER, slot),
+                        chessboardLayout.lineSize[slot], record(maskRuns));
+                    assert(viewRuns == maskRuns);
+                }
+            }
+        }
+    }
+}
+
+void testFindFive() {
+    ChessboardGrid grid;
+    for (int i = 0; i < 4; i++) grid.set(10 - i, 3 + i, PLAYER);
+    grid.set(3, 3, BOT);
+    assert(grid.findFive() == EMPTY && !grid.isFiveAt(PLAYER, 7, 6));
+    grid.set(6, 7, PLAYER);
+    printf("%d\n", grid.findFive());
+    assert(grid.findFive() == PLAYER && grid.isFiveAt(PLAYER, 6, 7) && grid.isFiveAt(PLAYER, 10, 3));
+    assert(!grid.isFiveAt(BOT, 6, 7) && !grid.isFiveAt(PLAYER, 6, 6));
+
+    grid = ChessboardGrid();
+    for (int j = 9; j < SIZE; j++) grid.set(14, j, BOT);
+    assert(grid.findFive() == BOT && grid.isFiveAt(BOT, 14, 14));
+    grid.set(14, 11, PLAYER);
+    assert(grid.findFive() == EMPTY && !grid.isFiveAt(BOT, 14, 14));
+}
+
+void testBitKernelConsistency() {
+    const BitKernel & generic = BitKernelTable[C2MI(BitKernelISA::GENERIC)];
+    uint64_t seed = 0x9E3779B97F4A7C15ull;
+    printf("%s\n", BitKernelTable[C2MI(activeBitKernelISA)].name);
+    for (int isa = C2MI(BitKernelISA::GENERIC); isa < C2MI(BitKernelISA::SIZE); isa++) {
+        if (!isBitKernelISASupported(static_cast<BitKernelISA>(isa))) continue;
+        const BitKernel & kernel = BitKernelTable[isa];
+        for (int round = 0; round < 4096; round++) {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            uint64_t value = round < 2 ? -round : seed, mask = seed * 0xBF58476D1CE4E5B9ull;
+            int start = seed % 64, end = start + (seed >> 8) % (64 - start);
+            uint64_t genericLeft, genericRight, left, right;
+            generic.countZerosAround(value, start, &genericLeft, &genericRight);
+            kernel.countZerosAround(value, start, &left, &right);
+            assert(genericLeft == left && genericRight == right);
+            assert(generic.countOnes(value, start, end) == kernel.countOnes(value, start, end));
+            assert(generic.countTrailingZeros(value) == kernel.countTrailingZeros(value));
+            assert(generic.extractBits(value, mask) == kernel.extractBits(value, mask));
+            assert(generic.depositBits(value, mask) == kernel.depositBits(value, mask));
+        }
+        assert(kernel.countTrailingZeros(0) == 64);
+        assert(kernel.countOnes(-1, 0, 63) == 64);
+    }
+
+    // The search is entered once per build with its kernels inlined; every build searches the same tree
+    const int moves[][3] = { { 7, 7, PLAYER }, { 7, 8, BOT }, { 8, 8, PLAYER }, { 6, 6, BOT }, { 9, 9, PLAYER } };
+    GobangSearchLimits limits = { 6, 0, 0 };
+    BitKernelISA active = activeBitKernelISA;
+    GobangSearchResult reference = {};
+    for (int isa = C2MI(BitKernelISA::GENERIC); isa < C2MI(BitKernelISA::SIZE); isa++) {
+        if (!isBitKernelISASupported(static_cast<BitKernelISA>(isa))) continue;
+        activeBitKernelISA = static_cast<BitKernelISA>(isa);
+        GobangEngineHandle engine(16);
+        for (auto & move : moves) engine.applyMove(move[0], move[1], move[2]);
+        GobangSearchResult result;
+        engine.search(result, limits);
+        if (isa == C2MI(BitKernelISA::GENERIC)) reference = result;
+        assert(result.nodes == reference.nodes && result.score == reference.score);
+        assert(result.move.x == reference.move.x && result.move.y == reference.move.y);
+    }
+    activeBitKernelISA = active;
+}
+
+void testEngineRequestParser() {
+    EngineRequest request;
+    const char * history = "{\"requests\": [{\"x\": -1, \"y\": -1}, {\"x\": 7, \"y\": 8}], \"responses\": [{\"x\": 7, \"y\": 7}], \"type\": 1}";
+    assert(parseEngineRequest(history, strlen(history), request));
+    assert(request.hasHistory && request.type == 1 && request.requestCount == 2 && request.responseCount == 1);
+    assert(request.requests[0].x == -1 && request.requests[1].y == 8 && request.responses[0].x == 7);
+
+    const char * incremental = "{\"setup\":{\"board\":\"0120\"},\"move\":{\"x\":3,\"y\":4}}";
+    assert(parseEngineRequest(incremental, strlen(incremental), request));
+    assert(!request.hasHistory && request.type == 0 && request.hasMove && request.move.x == 3 && request.move.y == 4);
+    assert(request.hasSetup && request.boardLength == 4 && request.board[1] == '1');
+
+    // Left to the jsoncpp fallback
+    const char * unsupported[] = {
+        "{\"type\":0,\"data\":\"\"}",
+        "{\"requests\":[{\"x\":1,\"y\":1}],\"responses\":[{\"x\":1,\"y\":1}]}",
+        "{\"move\":{\"x\":1.5,\"y\":1}}",
+        "{\"type\":0} trailing",
+    };
+    for (const char * text : unsupported)
+        assert(!parseEngineRequest(text, strlen(text), request));
+
+    char buffer[64];
+    EngineResponse response;
+    response.kind = EngineResponseKind::MOVE;
+    response.move = ChessPosition(7, 12);
+    writeEngineResponse(response, buffer, sizeof(buffer));
+    printf("%s", buffer);
+    assert(!strcmp(buffer, "{\"response\":{\"x\":7,\"y\":12}}\n"));
+    response = EngineResponse();
+    response.winner = BOT;
+    response.prompt = "Bot wins!";
+    writeEngineResponse(response, buffer, sizeof(buffer));
+    assert(!strcmp(buffer, "{\"prompt\":\"Bot wins!\",\"status\":1}\n"));
+    assert(!writeEngineResponse(response, buffer, 8));
+}
+
+void testBinaryEngineProtocol() {
+    EngineRequest request, decoded;
+    request.hasHistory = true;
+    request.type = 1;
+    request.requestCount = 2;
+    request.responseCount = 1;
+    request.requests[0] = ChessPosition(-1, -1);
+    request.requests[1] = ChessPosition(14, 14);
+    request.responses[0] = ChessPosition(7, 7);
+    request.hasSetup = true;
+    request.boardLength = SIZE * SIZE;
+    memset(request.board, '0', sizeof(request.board));
+    request.board[0] = '1';
+    request.board[SIZE * SIZE - 1] = '2';
+    request.hasMove = true;
+    request.move = ChessPosition(3, 4);
+
+    uint8_t frame[BINARY_MAX_FRAME_SIZE];
+    int frameSize = encodeBinaryEngineRequest(request, frame);
+    printf("%d\n", frameSize);
+    assert(frameSize == BINARY_HEADER_SIZE + 2 + 3 + 2 * BINARY_MASK_SIZE + 1);
+    assert(readBinaryPayloadLength(frame) == frameSize - BINARY_HEADER_SIZE);
+    assert(decodeBinaryEngineRequest(frame, frame + BINARY_HEADER_SIZE, decoded));
+    assert(decoded.type == 1 && decoded.hasHistory && decoded.requestCount == 2 && decoded.responseCount == 1);
+    assert(decoded.requests[0].x == -1 && decoded.requests[1].y == 14 && decoded.responses[0].x == 7);
+    assert(decoded.hasSetup && !memcmp(decoded.board, request.board, SIZE * SIZE));
+    assert(decoded.hasMove && decoded.move.x == 3 && decoded.move.y == 4);
+
+    // An even history length cannot end with a request
+    frame[BINARY_HEADER_SIZE] = 2;
+    assert(!decodeBinaryEngineRequest(frame, frame + BINARY_HEADER_SIZE, decoded));
+
+    EngineResponse response, decodedResponse;
+    response.kind = EngineResponseKind::MOVE;
+    response.move = ChessPosition(7, 12);
+    frameSize = encodeBinaryEngineResponse(response, frame);
+    assert(decodeBinaryEngineResponse(frame, frameSize, decodedResponse));
+    assert(decodedResponse.kind == EngineResponseKind::MOVE && decodedResponse.move.x == 7 && decodedResponse.move.y == 12);
+    response = EngineResponse();
+    response.winner = PLAYER;
+    frameSize = encodeBinaryEngineResponse(response, frame);
+    assert(decodeBinaryEngineResponse(frame, frameSize, decodedResponse));
+    assert(decodedResponse.kind == EngineResponseKind::STATUS && decodedResponse.winner == PLAYER);
+}
+
+void testGobangEngines() {
+    const int moves[][3] = { { 7, 7, PLAYER }, { 7, 8, BOT }, { 8, 8, PLAYER }, { 6, 6, BOT }, { 9, 9, PLAYER } };
+    GobangSearchLimits limits = { 4, 0, 0 };
+
+    // Independent engines searching the same position concurrently agree with a sequential search
+    GobangEngineHandle engines[3];
+    for (GobangEngineHandle & engine : engines)
+        for (auto & move : moves) {
+            bool placed = engine.applyMove(move[0], move[1], move[2]);
+            assert(placed);
+        }
+    GobangSearchResult sequential, concurrent[2];
+    bool searched = engines[0].search(sequential, limits);
+    assert(searched);
+    std::thread threads[2];
+    for (int i = 0; i < 2; i++)
+        threads[i] = std::thread([&, i] { engines[i + 1].search(concurrent[i], limits); });
+    for (std::thread & thread : threads) thread.join();
+    printf("%d %d %d\n", sequential.move.x, sequential.move.y, sequential.completedDepth);
+    assert(sequential.completedDepth == 4);
+    for (GobangSearchResult & result : concurrent)
+        assert(result.move.x == sequential.move.x && result.move.y == sequential.move.y && result.nodes == sequential.nodes);
+
+    // The player's 7,7 - 8,8 - 9,9 - 10,10 is blocked at 6,6 only, the bot has to take 11,11
+    engines[0].applyMove(10, 10, PLAYER);
+    GobangSearchResult defence;
+    engines[0].search(defence, limits);
+    assert(defence.move.x == 11 && defence.move.y == 11);
+
+    // Empty board opens in the center; a node limit cuts the deepest iterations short
+    GobangEngineHandle empty;
+    GobangSearchResult opening;
+    empty.search(opening);
+    assert(opening.move.x == 7 && opening.move.y == 7);
+    GobangSearchLimits nodeLimited = { 0, 0, 1 };
+    GobangSearchResult limited;
+    engines[1].search(limited, nodeLimited);
+    assert(limited.completedDepth < 10 && limited.nodes < 4096);
+    // Node limits below the interval of the time checks are honoured too, up to the path being searched
+    GobangSearchLimits fewNodes = { 0, 0, 500 };
+    engines[2].search(limited, fewNodes);
+    printf("%llu\n", limited.nodes);
+    assert(limited.nodes >= 500 && limited.nodes <= 500 + MAX_DEPTH);
+
+    // A cleared engine searches as a new one, though the old entries are still in its table
+    engines[0].clear();
+    GobangEngineHandle fresh;
+    for (auto & move : moves) fresh.applyMove(move[0], move[1], move[2]);
+    fresh.applyMove(10, 10, PLAYER);
+    GobangSearchResult cleared, reference;
+    for (int i = 0; i < 3; i++) {
+        engines[0].search(cleared, limits);
+        fresh.search(reference, limits);
+    }
+    assert(cleared.move.x == reference.move.x && cleared.move.y == reference.move.y && cleared.nodes == reference.nodes);
+
+    // Invalid limits are rejected up front and leave a zeroed result
+    GobangSearchLimits oddDepth = { 3, 0, 0 }, tooDeep = { 12, 0, 0 };
+    assert(!isGobangSearchLimitsValid(&oddDepth) && !isGobangSearchLimitsValid(&tooDeep));
+    assert(isGobangSearchLimitsValid(&limits) && isGobangSearchLimitsValid(&nodeLimited));
+    searched = empty.search(limited, oddDepth);
+    assert(!searched && limited.nodes == 0 && limited.completedDepth == 0);
+    bool rejected = false;
+    try {
+        GobangEngineHandle tiny(GOBANG_MIN_TABLE_BITS - 1);
+    } catch (const std::out_of_range &) {
+        rejected = true;
+    }
+    assert(rejected);
+}
+
+void testResumableSearch() {
+    const int moves[][3] = { { 7, 7, PLAYER }, { 7, 8, BOT }, { 8, 8, PLAYER }, { 6, 6, BOT }, { 9, 9, PLAYER } };
+    GobangSearchLimits limits = { 6, 0, 0 };
+    GobangEngineHandle engines[5] = { GobangEngineHandle(16), GobangEngineHandle(16), GobangEngineHandle(16), GobangEngineHandle(16), GobangEngineHandle(16) };
+    for (GobangEngineHandle & engine : engines)
+        for (auto & move : moves) engine.applyMove(move[0], move[1], move[2]);
+
+    // Sliced into 100-node steps the search takes the same path as in one call
+    GobangSearchResult whole, sliced;
+    engines[0].search(whole, limits);
+    int slices = 1;
+    engines[1].beginSearch(limits);
+    while (!engines[1].continueSearch(100, sliced)) slices++;
+    printf("%d %d %llu %d\n", whole.move.x, whole.move.y, whole.nodes, slices);
+    assert(slices > 10);
+    assert(sliced.move.x == whole.move.x && sliced.move.y == whole.move.y);
+    assert(sliced.nodes == whole.nodes && sliced.completedDepth == whole.completedDepth);
+
+    // An abandoned search leaves the board as it was: the forced defence at 11,11 is still found
+    engines[2].applyMove(10, 10, PLAYER);
+    engines[2].beginSearch(limits);
+    bool finished = engines[2].continueSearch(100, sliced);
+    assert(!finished);
+    engines[2].abandonSearch();
+    GobangSearchResult defence;
+    engines[2].search(defence, limits);
+    assert(defence.move.x == 11 && defence.move.y == 11);
+
+    // Two searches of the same position on one thread: the one of priority 4 gets four times the
+    // nodes per round, finishes first, and both end as the unsliced search did
+    std::mutex mutex;
+    std::condition_variable finishedCondition;
+    std::vector<int> order;
+    GobangSearchResult results[2];
+    {
+        SearchScheduler scheduler(1, 100);
+        GobangEngine * scheduled[2] = { engines[3].get(), engines[4].get() };
+        for (int i = 0; i < 2; i++) {
+            bool submitted = scheduler.submit(scheduled[i], limits, i == 0 ? 1 : 4, [&, i] (const GobangSearchResult & result) {
+                std::lock_guard<std::mutex> lock(mutex);
+                results[i] = result;
+                order.push_back(i);
+                finishedCondition.notify_one();
+            });
+            assert(submitted);
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        finishedCondition.wait(lock, [&] { return order.size() == 2; });
+    }
+    assert(order[0] == 1);
+    for (GobangSearchResult & result : results)
+        assert(result.move.x == whole.move.x && result.move.y == whole.move.y && result.nodes == whole.nodes);
+}
+
+void testSearchStartDepth() {
+    // Iterative deepening starts deeper only where the last search left its subtree: after the
+    // expected reply, not after any other one
+    const int moves[][3] = { { 7, 7, PLAYER }, { 7, 8, BOT }, { 8, 8, PLAYER }, { 6, 6, BOT }, { 9, 9, PLAYER } };
+    for (int expected = 0; expected < 2; expected++) {
+        std::unique_ptr<Gobang> gobang(new Gobang(16));
+        for (auto & move : moves) gobang->placeAt(move[0], move[1], static_cast<ChessPiece>(move[2]));
+        gobang->ChoosePosition(8);
+        assert(gobang->lastCompletedDepth == 8 && gobang->hasExpectedReply);
+        ChessPosition own = gobang->chosenPosition, reply = gobang->expectedReply;
+        gobang->placeAt(own.x, own.y, BOT);
+        if (expected) gobang->placeAt(reply.x, reply.y, PLAYER);
+        else gobang->placeAt(reply.x ? 0 : 1, 0, PLAYER);
+        gobang->beginChoosePosition(8);
+        assert(gobang->DEPTH == (expected ? 6 : 4));
+        gobang->abandonChoosePosition();
+    }
+}
+
+void testGameStore() {
+    std::string path = "/tmp/gridTestStore." + std::to_string(getpid());
+    unlink(path.c_str());
+    unlink(gameStoreIndexPath(path).c_str());
+    const ChessPosition moves[] = { { 7, 7 }, { 7, 8 }, { 8, 8 }, { 6, 6 }, { 9, 9 } };
+    const ChessPosition offBoard[] = { { 7, 7 }, { 15, 0 } };
+
+    // Two writers on one store, batches interleaved; a rejected game leaves no record
+    GameStoreWriter first, second;
+    bool opened = first.open(path) && second.open(path);
+    assert(opened);
+    bool added = first.add(moves, 5, GameStoreResult::BLACK, "first", 5) && second.add(moves, 3, GameStoreResult::DRAW) &&
+        !second.add(offBoard, 2, GameStoreResult::WHITE);
+    assert(added);
+    bool flushed = second.flush() && first.flush() && first.add(moves, 1, GameStoreResult::UNKNOWN);
+    assert(flushed);
+    first.close();
+    second.close();
+
+    GameStoreReader reader;
+    opened = reader.open(path);
+    assert(opened && reader.size() == 3);
+    GameStoreView game;
+    bool found = reader.game(0, game);
+    assert(found && game.moveCount == 3 && game.result == GameStoreResult::DRAW && game.metadataLength == 0);
+    found = reader.game(1, game);
+    assert(found && game.moveCount == 5 && game.result == GameStoreResult::BLACK && !memcmp(game.metadata, "first", 5));
+    assert(game.move(4).x == 9 && game.move(4).y == 9);
+    assert(!reader.game(3, game));
+
+    // Sampling covers every position (3 + 5 + 1) and only real ones
+    std::mt19937_64 generator(1);
+    int seen[3][5] = {};
+    for (int i = 0; i < 2000; i++) {
+        size_t gameIndex;
+        int ply;
+        bool sampled = reader.samplePosition(generator, gameIndex, ply);
+        found = sampled && reader.game(gameIndex, game);
+        assert(found && ply < game.moveCount);
+        seen[gameIndex][ply]++;
+    }
+    int covered = 0;
+    for (auto & plies : seen)
+        for (int count : plies) covered += count != 0;
+    printf("%d\n", covered);
+    assert(covered == 9);
+
+    // The index is rebuilt from the records alone, without a corrupt tail: a header claiming more
+    // moves than a board holds, followed by enough bytes to look whole
+    int tailFd = open(path.c_str(), O_WRONLY | O_APPEND);
+    GameStoreRecordHeader corrupt = { GAME_STORE_MAX_MOVES + 1, 0, 0, 0, 0 };
+    std::string tail((const char *) &corrupt, sizeof(corrupt));
+    tail.append(GAME_STORE_MAX_MOVES + 1, 0);
+    bool appended = tailFd != -1 && write(tailFd, tail.data(), tail.size()) == (ssize_t) tail.size();
+    assert(appended);
+    close(tailFd);
+    unlink(gameStoreIndexPath(path).c_str());
+    bool rebuilt = rebuildGameStoreIndex(path) && reader.refresh();
+    assert(rebuilt && reader.size() == 3);
+    found = reader.game(2, game);
+    assert(found && game.moveCount == 1 && game.move(0).x == 7);
+    unlink(path.c_str());
+    unlink(gameStoreIndexPath(path).c_str());
+}
+
+void testEnginePool() {
+    // cat echoes the warmup line, so every pooled engine has answered once
+    EnginePool pool;
+    bool initialized = initEnginePool(&pool, "/bin/cat", 2, 0, "warmup\n");
+    assert(initialized && pool.readyCount == 2);
+
+    EngineProcess engine;
+    bool acquired = acquireEngineFromPool(&pool, &engine);
+    assert(acquired && pool.readyCount == 1);
+    char * reply;
+    unsigned long replySize;
+    bool exchanged = exchangeLineWithProcess(engine.stdinFd, engine.stdoutFd, "ping\n", 5, &reply, &replySize, 5, 0);
+    assert(exchanged && replySize == 5 && memcmp(reply, "ping\n", 5) == 0);
+    if (exchanged) free(reply);
+
+    // A spare that died is noticed, then skipped by acquire, which spawns a fresh engine instead
+    kill(pool.ready[0].pid, SIGKILL);
+    int exited = waitAnyEngineProcess(pool.ready, pool.readyCount, 5000);
+    assert(exited == 0);
+    EngineProcess replacement;
+    acquired = acquireEngineFromPool(&pool, &replacement);
+    assert(acquired && pool.readyCount == 0 && replacement.pid != -1);
+    assert(waitAnyEngineProcess(&replacement, 1, 0) == -1);
+    bool refilled = refillEnginePool(&pool);
+    assert(refilled && pool.readyCount == 2);
+
+    // An acquired engine is reaped once it exits
+    kill(engine.pid, SIGKILL);
+    assert(waitAnyEngineProcess(&engine, 1, 5000) == 0);
+    int status;
+    assert(reapEngineProcess(&engine, &status, 1) == 1 && WIFSIGNALED(status) && engine.pid == -1);
+    closeEngineProcess(&engine, 0);
+    closeEngineProcess(&replacement, 1);
+    destroyEnginePool(&pool);
+    assert(pool.ready == NULL);
+
+    // Writing to an engine that exited unread fails with EPIPE rather than raising SIGPIPE, and the
+    // pipe gets its blocking flags back
+    EngineProcess gone;
+    bool spawned = spawnEngineProcess("/bin/true", &gone, 0);
+    assert(spawned && reapEngineProcess(&gone, &status, 1) == 1);
+    std::string request(1 << 20, '\n');
+    exchanged = exchangeLineWithProcess(gone.stdinFd, gone.stdoutFd, request.data(), request.size(), &reply, &replySize, 5, 0);
+    assert(!exchanged && !(fcntl(gone.stdinFd, F_GETFL) & O_NONBLOCK));
+    closeEngineProcess(&gone, 0);
+}
+
+void testArenaStats() {
+    assert(fabs(eloToScore(0) - 0.5) < 1e-12);
+    assert(fabs(scoreToElo(eloToScore(100)) - 100) < 1e-9);
+
+    MatchScore match;
+    for (int i = 0; i < 120; i++) match.add(1);
+    for (int i = 0; i < 40; i++) match.add(0.5);
+    for (int i = 0; i < 40; i++) match.add(0);
+    double lower, upper;
+    double elo = match.elo(lower, upper);
+    printf("%.1f %.1f %.1f\n", elo, lower, upper);
+    assert(match.games() == 200 && fabs(match.score() - 0.7) < 1e-12);
+    assert(fabs(elo - scoreToElo(0.7)) < 1e-9 && lower < elo && elo < upper);
+    assert(match.sprt(0, 10, 0.05, 0.05) == SprtState::ACCEPT_H1);
+
+    // An even match rejects a 10 Elo gain only after thousands of games
+    MatchScore even;
+    even.wins = even.losses = 2500;
+    assert(even.sprt(0, 10, 0.05, 0.05) == SprtState::CONTINUE);
+    even.wins = even.losses = 5000;
+    assert(even.sprt(0, 10, 0.05, 0.05) == SprtState::ACCEPT_H0);
+    // No spread yet, no decision
+    MatchScore drawn;
+    drawn.draws = 50;
+    assert(drawn.sprt(0, 10, 0.05, 0.05) == SprtState::CONTINUE);
+}
+
 int main() {
     testGetContiguousZeroCount1();
     testGetContiguousZeroCount2();
@@ -210,4 +718,16 @@ int main() {
     testGetSingleChessChainStatus2();
     testGetSingleChessChainStatus3();
     testGetSingleChessChainStatus4();
+    testChessboardLayout();
+    testTraverseLineMasks();
+    testFindFive();
+    testBitKernelConsistency();
+    testEngineRequestParser();
+    testBinaryEngineProtocol();
+    testGobangEngines();
+    testResumableSearch();
+    testSearchStartDepth();
+    testGameStore();
+    testArenaStats();
+    testEnginePool();
 }
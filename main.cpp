@@ -1,25 +1,65 @@
 #include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
+#include <signal.h>
 #include "jsoncpp/json.h"
 #include "gobang.h"
+#include "grid.hpp"
+#include "winJudge.h"
 #include "exec.h"
+#include "engineProtocol.hpp"
+#include "gameStore.hpp"
 
-ChessPiece grid[SIZE][SIZE];
+ChessboardGrid grid;
 const char chessPieceChar[] = " XO";
 const char chessPieceCurrentChar[] = " *#";
 int curPlayerX = -1, curPlayerY = -1;
 int curRobotX = -1, curRobotY = -1;
 int timeout = 15;
+constexpr int ENGINE_REPLY_GRACE = 2; // Seconds the engine may take beyond TIMEOUT to reply
 bool restrictedMove = false;
+bool binaryProtocol = false;
 
-Json::Value message;
+EngineProcess engine = { -1, -1, -1, -1 };
+EngineRequest engineRequest;
+bool hasPendingMove = false; // Player placement not yet sent to the engine
+ChessPosition pendingMove;
+
+const char * gameStorePath = NULL; // Finished games are appended to this game store
+std::vector<ChessPosition> gameMoves; // Moves of the game so far, first mover first
+ChessPiece firstMover = PLAYER;
+bool newGame = false; // The next engine request clears the engine's board first
+
+/*
+    Headless mode (HEADLESS set): no rendering or prompts; games are played until the input runs out
+    and every move and game is printed as a JSON line. The player's side is either a script
+    (HEADLESS_SCRIPT, one game per line of moves in the interactive notation, e.g. "H7 H8 I9") or a
+    second engine (HEADLESS_OPPONENT, an engine path, playing HEADLESS_GAMES games). HEADLESS_FIRST=robot
+    lets the robot open. Both engines run through the same exec.c path as interactive games.
+*/
+bool headless = false;
+const char * scriptPath = NULL;
+const char * opponentPath = NULL;
+int headlessGames = 1;
+FILE * scriptFile = NULL;
+EngineProcess opponent = { -1, -1, -1, -1 };
+std::vector<ChessPosition> scriptMoves; // Player moves of the current scripted game
+size_t scriptCursor = 0;
+int gameNumber = 0;
+ChessPiece gameWinner = EMPTY;
+std::vector<double> robotLatencies; // Milliseconds per robot move over all games
+double sideMilliseconds[PIECE_END + 1]; // Per game, indexed by ChessPiece
 
 void clearScreen() {
     printf("\033c");
     printf("Configurations: \n");
     printf("  - Current timeout (TIMEOUT): %ds\n", timeout);
     printf("  - Restricted move (RESTRICTED_MOVE): %s\n", restrictedMove ? "Yes" : "No");
+    printf("  - Binary protocol (BINARY_PROTOCOL): %s\n", binaryProtocol ? "Yes" : "No");
+    printf("  - Game store (GAME_STORE): %s\n", gameStorePath ? gameStorePath : "No");
     printf("\n");
 }
 void printSeparatorLine() {
@@ -29,11 +69,11 @@ void printSeparatorLine() {
     }
     printf("-\n");
 }
-void printGridLine(int line, ChessPiece arr[]) {
+void printGridLine(int line) {
     printf("%2d ", line);
     for (int i = 0; i < SIZE; i++) {
         char c;
-        c = chessPieceChar[arr[i]];
+        c = chessPieceChar[grid.get(line, i)];
         if (curRobotX == line && curRobotY == i) c = chessPieceCurrentChar[1];
         if (curPlayerX == line && curPlayerY == i) c = chessPieceCurrentChar[2];
         printf("|%c", c);
@@ -50,7 +90,7 @@ void printRowLableLine() {
 void displayGrid() {
     for (int i = 0; i < SIZE; i++) {
         printSeparatorLine();
-        printGridLine(i, grid[i]);
+        printGridLine(i);
     }
     printSeparatorLine();
     printRowLableLine();
@@ -59,123 +99,313 @@ std::string getJSONText(Json::Value & json) {
     Json::FastWriter writer;
     return writer.write(json);
 }
-void initJSONMessage() {
-    message["requests"] = Json::Value(Json::arrayValue);
-    message["responses"] = Json::Value(Json::arrayValue);
+void stopEngine() {
+    closeEngineProcess(&engine, 0);
 }
-bool player(bool inputFlag = true) {
-    int row = -1, column = -1;
-    char columnC;
-
-    if (inputFlag) {
-        clearScreen();
-        displayGrid();
-
-        while (1) {
-            printf("Please input placement position (e.g. H7):");
-            if (scanf(" %c%d", &columnC, &row) != 2) return false;
-            if (columnC < 'A' || columnC > 'O') return false;
-            if (row < 0 || row > 14) return false;
-            column = columnC - 'A';
-
-            if (grid[row][column] != EMPTY) {
-                clearScreen();
-                printf("On %c%d already placed chess!\n", columnC, row);
-                displayGrid();
-                continue;
-            }
-            grid[row][column] = PLAYER;
-            break;
-        }
-        
-        curPlayerX = row;
-        curPlayerY = column;
-    }
-    
-    Json::Value placement;
-    placement["x"] = row;
-    placement["y"] = column;
-    message["requests"].append(placement);
+bool startEngine() {
+    // One long-running engine for the whole game, fed with incremental requests
+    setenv("KEEP_RUNNING", "1", 1);
+    setenv("TIMEOUT", std::to_string(timeout).c_str(), 1);
+    if (!spawnEngineProcess("./gobang", &engine, 0)) return false;
+    atexit(stopEngine);
     return true;
 }
-bool robot() {
-    message["type"] = 0;
+bool askEngineJSON(EngineProcess & process, const EngineRequest & request, EngineResponse & response, int prompt) {
+    Json::Value message, reply;
+    message["type"] = request.type;
+    if (request.hasSetup) message["setup"]["board"] = std::string(request.board, request.boardLength);
+    if (request.hasMove) {
+        message["move"]["x"] = request.move.x;
+        message["move"]["y"] = request.move.y;
+    }
     std::string serializedJSONMessage = getJSONText(message);
-    serializedJSONMessage.append("\n");
-    printf("Debug: %s", serializedJSONMessage.c_str());
-    
-    char responseBuf[0x1000];
+    if (prompt) printf("Debug: %s", serializedJSONMessage.c_str());
+
+    char * responseBuf;
     unsigned long responseSize;
-    int retValue = createProcessWithGivenStdinAndGetStdout(
-        "./gobang",
+    int retValue = exchangeLineWithProcess(
+        process.stdinFd, process.stdoutFd,
         serializedJSONMessage.c_str(), serializedJSONMessage.size(),
-        responseBuf, sizeof(responseBuf) - 1, &responseSize,
-        timeout, 1
+        &responseBuf, &responseSize,
+        timeout + ENGINE_REPLY_GRACE, prompt
     );
     if (!retValue) return false;
-    responseBuf[responseSize] = '\0';
 
     Json::Reader reader;
-    Json::Value response;
-    reader.parse(responseBuf, response);
+    bool parsed = reader.parse(responseBuf, responseBuf + responseSize, reply);
+    free(responseBuf);
+    if (!parsed || !reply.isMember("response")) return false;
+    response.kind = EngineResponseKind::MOVE;
+    response.move = ChessPosition(reply["response"]["x"].asInt(), reply["response"]["y"].asInt());
+    return true;
+}
+bool askEngineBinary(EngineProcess & process, const EngineRequest & request, EngineResponse & response, int prompt) {
+    uint8_t frame[BINARY_MAX_FRAME_SIZE];
+    int frameSize = encodeBinaryEngineRequest(request, frame);
+    if (prompt) printf("Debug: binary frame, %d bytes\n", frameSize);
 
-    int x, y;
-    x = response["response"]["x"].asInt();
-    y = response["response"]["y"].asInt();
+    char * responseBuf;
+    unsigned long responseSize;
+    int retValue = exchangeFrameWithProcess(
+        process.stdinFd, process.stdoutFd,
+        (const char *) frame, frameSize,
+        &responseBuf, &responseSize,
+        timeout + ENGINE_REPLY_GRACE, prompt
+    );
+    if (!retValue) return false;
 
-    grid[x][y] = BOT;
-    curRobotX = x;
-    curRobotY = y;
+    bool decoded = decodeBinaryEngineResponse((const uint8_t *) responseBuf, responseSize, response);
+    free(responseBuf);
+    return decoded && response.kind == EngineResponseKind::MOVE;
+}
+// Ask an engine for its move, sending the opposing side's last move along and clearing its board at a new game
+bool askEngineProcess(EngineProcess & process, bool clearBoard, bool hasMove, const ChessPosition & move, EngineResponse & response, int prompt) {
+    engineRequest.clear();
+    engineRequest.type = 0;
+    engineRequest.hasSetup = clearBoard;
+    engineRequest.hasMove = hasMove;
+    engineRequest.move = move;
+    if (binaryProtocol) return askEngineBinary(process, engineRequest, response, prompt);
+    return askEngineJSON(process, engineRequest, response, prompt);
+}
+// Ask the engine for its move, sending the pending player placement along
+bool askEngine(EngineResponse & response, int prompt) {
+    bool clearBoard = newGame, hasMove = hasPendingMove;
+    newGame = hasPendingMove = false;
+    return askEngineProcess(engine, clearBoard, hasMove, pendingMove, response, prompt);
+}
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+void printHeadlessMove(ChessPiece side, const ChessPosition & move, double milliseconds) {
+    printf("{\"game\":%d,\"ply\":%zu,\"side\":\"%s\",\"x\":%d,\"y\":%d,\"ms\":%.3f}\n", gameNumber, gameMoves.size() - 1,
+        side == BOT ? "robot" : "player", move.x, move.y, milliseconds);
+}
+// The player's move in headless mode, from the script or the opponent engine
+bool headlessPlayer() {
+    ChessPosition move;
+    auto start = std::chrono::steady_clock::now();
+    if (opponentPath) {
+        EngineResponse response;
+        bool opening = gameMoves.empty();
+        if (!askEngineProcess(opponent, opening || gameMoves.size() == 1, !opening, opening ? ChessPosition() : gameMoves.back(), response, 0))
+            return false;
+        move = response.move;
+    } else {
+        if (scriptCursor == scriptMoves.size()) return false;
+        move = scriptMoves[scriptCursor++];
+    }
+    double milliseconds = millisecondsSince(start);
+    if (move.x < 0 || move.y < 0 || move.x >= SIZE || move.y >= SIZE || grid.get(move.x, move.y) != EMPTY) return false;
+    grid.set(move.x, move.y, PLAYER);
+    curPlayerX = move.x;
+    curPlayerY = move.y;
+    pendingMove = move;
+    hasPendingMove = true;
+    gameMoves.push_back(move);
+    sideMilliseconds[PLAYER] += milliseconds;
+    printHeadlessMove(PLAYER, move, milliseconds);
+    return true;
+}
+bool player() {
+    if (headless) return headlessPlayer();
+    int row = -1, column = -1;
+    char columnC;
+
+    clearScreen();
+    displayGrid();
+
+    while (1) {
+        printf("Please input placement position (e.g. H7):");
+        if (scanf(" %c%d", &columnC, &row) != 2) return false;
+        if (columnC < 'A' || columnC > 'O') return false;
+        if (row < 0 || row > 14) return false;
+        column = columnC - 'A';
+
+        if (grid.get(row, column) != EMPTY) {
+            clearScreen();
+            printf("On %c%d already placed chess!\n", columnC, row);
+            displayGrid();
+            continue;
+        }
+        grid.set(row, column, PLAYER);
+        break;
+    }
 
-    Json::Value placement;
-    placement["x"] = x;
-    placement["y"] = y;
-    message["responses"].append(placement);
+    curPlayerX = row;
+    curPlayerY = column;
 
+    pendingMove = ChessPosition(row, column);
+    hasPendingMove = true;
+    gameMoves.push_back(pendingMove);
     return true;
 }
-bool judgeWins() {
-    message["type"] = 1;
-    std::string serializedJSONMessage = getJSONText(message);
-    serializedJSONMessage.append("\n");
-    
-    char responseBuf[0x1000];
-    unsigned long responseSize;
-    int retValue = createProcessWithGivenStdinAndGetStdout(
-        "./gobang",
-        serializedJSONMessage.c_str(), serializedJSONMessage.size(),
-        responseBuf, sizeof(responseBuf) - 1, &responseSize,
-        0, 0
-    );
-    if (!retValue) return false;
-    responseBuf[responseSize] = '\0';
+bool robot() {
+    EngineResponse response;
+    auto start = std::chrono::steady_clock::now();
+    if (!askEngine(response, headless ? 0 : 1)) return false;
+    double milliseconds = millisecondsSince(start);
 
-    Json::Reader reader;
-    Json::Value response;
-    reader.parse(responseBuf, response);
+    int x, y;
+    x = response.move.x;
+    y = response.move.y;
+    if (headless && (x < 0 || y < 0 || x >= SIZE || y >= SIZE || grid.get(x, y) != EMPTY)) return false;
+
+    grid.set(x, y, BOT);
+    curRobotX = x;
+    curRobotY = y;
+    gameMoves.push_back(ChessPosition(x, y));
+    if (headless) {
+        sideMilliseconds[BOT] += milliseconds;
+        robotLatencies.push_back(milliseconds);
+        printHeadlessMove(BOT, response.move, milliseconds);
+    }
 
-    int status = response["status"].asInt();
-    if (status == 1) {
+    return true;
+}
+void saveGame(ChessPiece winner) {
+    if (!gameStorePath) return;
+    GameStoreWriter store;
+    char metadata[128];
+    int metadataLength = snprintf(metadata, sizeof(metadata), "main timeout=%d restrictedMove=%d first=%s",
+        timeout, restrictedMove, firstMover == PLAYER ? "player" : "robot");
+    GameStoreResult result = winner == EMPTY ? GameStoreResult::DRAW
+        : winner == firstMover ? GameStoreResult::BLACK : GameStoreResult::WHITE;
+    if (!store.open(gameStorePath) || !store.add(gameMoves.data(), gameMoves.size(), result, metadata, metadataLength) || !store.flush())
+        perror(gameStorePath);
+}
+bool judgeWins(int x, int y) {
+    // In-process check of the four lines through the last move
+    ChessPiece winner = judgeWinsAt(grid, x, y);
+    const char * prompt = getWinPrompt(winner);
+    if (headless) {
+        // A full board is a draw
+        if (!prompt && gameMoves.size() < SIZE * SIZE) return true;
+        gameWinner = winner;
+        saveGame(winner);
+        return false;
+    }
+    if (prompt) {
+        saveGame(winner);
         clearScreen();
         displayGrid();
-        printf("%s\n", response["prompt"].asCString());
+        printf("%s\n", prompt);
         return false;
     }
     return true;
 }
 void init() {
-    initJSONMessage();
+    signal(SIGPIPE, SIG_IGN);
 
     char * timeoutEnv = std::getenv("TIMEOUT");
     if (timeoutEnv) timeout = std::strtol(timeoutEnv, NULL, 10);
     char * restrictedMoveEnv = std::getenv("RESTRICTED_MOVE");
     if (restrictedMoveEnv) restrictedMove = true;
+    // Inherited by the engine, so both ends switch protocol together
+    char * binaryProtocolEnv = std::getenv("BINARY_PROTOCOL");
+    if (binaryProtocolEnv) binaryProtocol = true;
+    gameStorePath = std::getenv("GAME_STORE");
+    headless = std::getenv("HEADLESS");
+    scriptPath = std::getenv("HEADLESS_SCRIPT");
+    opponentPath = std::getenv("HEADLESS_OPPONENT");
+    char * gamesEnv = std::getenv("HEADLESS_GAMES");
+    if (gamesEnv) headlessGames = std::strtol(gamesEnv, NULL, 10);
+    char * firstEnv = std::getenv("HEADLESS_FIRST");
+    if (firstEnv && std::string(firstEnv) == "robot") firstMover = BOT;
+}
+void stopOpponent() {
+    closeEngineProcess(&opponent, 0);
+}
+// Read the next scripted game; returns false at the end of the script or on a malformed move
+bool readScriptGame() {
+    char * line = NULL;
+    size_t capacity = 0;
+    ssize_t length;
+    scriptMoves.clear();
+    scriptCursor = 0;
+    while ((length = getline(&line, &capacity, scriptFile)) >= 0) {
+        char columnC;
+        int row, consumed;
+        const char * cursor = line;
+        while (sscanf(cursor, " %c%d%n", &columnC, &row, &consumed) == 2) {
+            if (columnC < 'A' || columnC > 'O' || row < 0 || row > 14) {
+                fprintf(stderr, "%s: bad move %c%d\n", scriptPath, columnC, row);
+                free(line);
+                return false;
+            }
+            scriptMoves.push_back(ChessPosition(row, columnC - 'A'));
+            cursor += consumed;
+        }
+        if (!scriptMoves.empty()) break; // Blank lines separate nothing
+    }
+    free(line);
+    return !scriptMoves.empty();
+}
+double percentile(std::vector<double> & sorted, double fraction) {
+    return sorted[std::min(sorted.size() - 1, (size_t) (fraction * sorted.size()))];
+}
+int runHeadless() {
+    if (!scriptPath == !opponentPath) {
+        fprintf(stderr, "HEADLESS needs exactly one of HEADLESS_SCRIPT and HEADLESS_OPPONENT\n");
+        return 2;
+    }
+    if (scriptPath && !(scriptFile = fopen(scriptPath, "r"))) {
+        perror(scriptPath);
+        return 1;
+    }
+    if (!startEngine()) return 3;
+    if (opponentPath) {
+        if (!spawnEngineProcess(opponentPath, &opponent, 0)) return 3;
+        atexit(stopOpponent);
+    }
+
+    int results[PIECE_END + 1] = {}, unfinished = 0;
+    for (gameNumber = 0; opponentPath ? gameNumber < headlessGames : readScriptGame(); gameNumber++) {
+        grid = ChessboardGrid();
+        gameMoves.clear();
+        curPlayerX = curPlayerY = curRobotX = curRobotY = -1;
+        hasPendingMove = false;
+        newGame = true;
+        gameWinner = EMPTY;
+        sideMilliseconds[BOT] = sideMilliseconds[PLAYER] = 0;
+
+        // A game ends unfinished when a side cannot move: the script ran out, or an engine failed
+        bool finished = false;
+        for (ChessPiece side = firstMover; ; side = side == PLAYER ? BOT : PLAYER) {
+            if (!(side == PLAYER ? player() : robot())) break;
+            if (!judgeWins(side == PLAYER ? curPlayerX : curRobotX, side == PLAYER ? curPlayerY : curRobotY)) {
+                finished = true;
+                break;
+            }
+        }
+        const char * result = !finished ? "unfinished" : gameWinner == BOT ? "robot" : gameWinner == PLAYER ? "player" : "draw";
+        if (finished) results[gameWinner]++;
+        else unfinished++;
+        printf("{\"game\":%d,\"result\":\"%s\",\"moves\":%zu,\"robotMs\":%.3f,\"playerMs\":%.3f}\n", gameNumber, result,
+            gameMoves.size(), sideMilliseconds[BOT], sideMilliseconds[PLAYER]);
+        fflush(stdout);
+        // An engine that failed mid-game may be out of step; stop rather than feed it the next game
+        if (!finished && opponentPath) break;
+    }
+    if (scriptFile) fclose(scriptFile);
+
+    fprintf(stderr, "%d games: robot %d, player %d, draw %d, unfinished %d\n", gameNumber,
+        results[BOT], results[PLAYER], results[EMPTY], unfinished);
+    if (!robotLatencies.empty()) {
+        std::sort(robotLatencies.begin(), robotLatencies.end());
+        double total = 0;
+        for (double latency : robotLatencies) total += latency;
+        fprintf(stderr, "robot latency over %zu moves: mean %.3fms, p50 %.3fms, p99 %.3fms, max %.3fms\n", robotLatencies.size(),
+            total / robotLatencies.size(), percentile(robotLatencies, 0.5), percentile(robotLatencies, 0.99), robotLatencies.back());
+    }
+    return 0;
 }
 int main() {
     bool flag;
     int choice;
 
     init();
+    if (headless) return runHeadless();
 
     clearScreen();
     printf("Choose who goes first:\n");
@@ -183,14 +413,16 @@ int main() {
     printf("1. Robot\n");
     if (scanf(" %d", &choice) != 1) return 1;
     if (choice != 0 && choice != 1) return 2;
+    firstMover = choice == 0 ? PLAYER : BOT;
 
-    if (choice == 1) player(false);
+    if (!startEngine()) return 3;
 
     while (1) {
         if (choice == 0) flag = player();
         else if (choice == 1) flag = robot();
         if (!flag) return 0;
-        if (!judgeWins()) return 0;
+        if (choice == 0 && !judgeWins(curPlayerX, curPlayerY)) return 0;
+        if (choice == 1 && !judgeWins(curRobotX, curRobotY)) return 0;
         choice = (choice + 1) % 2;
     }
 }
\ No newline at end of file
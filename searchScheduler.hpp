@@ -0,0 +1,117 @@
+#pragma once
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+#include <queue>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "gobangEngine.h"
+
+/*
+    Cooperative scheduler for many concurrent searches on a small thread pool.
+
+    A submitted search runs on whichever worker is free, sliceNodes nodes at a time through the
+    resumable engine API, and goes back to the run queue after every slice. The queue is ordered by
+    virtual time, the nodes a search has used divided by its priority (stride scheduling): while
+    searches are runnable, one of priority 2 gets twice the nodes of one of priority 1, and a newly
+    submitted search starts at the current virtual time rather than ahead of the searches already
+    waiting. The node quota of a search is its GobangSearchLimits::nodeLimit; when it is used up the
+    search completes with its best move so far.
+
+    The engine of a submitted search belongs to the scheduler until its callback has run; the
+    callback runs on a worker thread. stopGobangEngine may still be called at any time, and makes
+    the search complete in its next slice.
+*/
+
+class SearchScheduler {
+public:
+    using Callback = std::function<void(const GobangSearchResult &)>;
+
+private:
+    struct Task {
+        GobangEngine * engine;
+        int priority;
+        uint64_t virtualTime;
+        uint64_t sequence; // Submission order among equal virtual times
+        unsigned long long nodes; // Searched so far
+        Callback done;
+    };
+    struct LaterTask {
+        bool operator ()(const Task * a, const Task * b) const {
+            if (a->virtualTime != b->virtualTime) return a->virtualTime > b->virtualTime;
+            return a->sequence > b->sequence;
+        }
+    };
+    // Virtual time advances by nodes * VIRTUAL_TIME_SCALE / priority, so priorities up to the scale stay distinct
+    static constexpr uint64_t VIRTUAL_TIME_SCALE = 1024;
+
+    std::vector<std::thread> threads;
+    std::priority_queue<Task *, std::vector<Task *>, LaterTask> runQueue;
+    std::mutex queueMutex;
+    std::condition_variable tasksAvailable;
+    uint64_t currentVirtualTime = 0; // Virtual time of the task taken last
+    uint64_t nextSequence = 0;
+    unsigned long long sliceNodes;
+    bool stopping = false;
+
+    void work() {
+        while (true) {
+            Task * task;
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                tasksAvailable.wait(lock, [this] { return stopping || !runQueue.empty(); });
+                if (stopping) return;
+                task = runQueue.top();
+                runQueue.pop();
+                currentVirtualTime = task->virtualTime;
+            }
+            GobangSearchResult result;
+            if (continueGobangEngineSearch(task->engine, sliceNodes, &result)) {
+                task->done(result);
+                delete task;
+                continue;
+            }
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                task->virtualTime += (result.nodes - task->nodes) * VIRTUAL_TIME_SCALE / task->priority;
+                task->nodes = result.nodes;
+                runQueue.push(task);
+            }
+            tasksAvailable.notify_one();
+        }
+    }
+
+public:
+    SearchScheduler(int threadCount, unsigned long long sliceNodes): sliceNodes(sliceNodes) {
+        for (int i = 0; i < threadCount; i++)
+            threads.emplace_back([this] { work(); });
+    }
+    SearchScheduler(const SearchScheduler &) = delete;
+    SearchScheduler & operator =(const SearchScheduler &) = delete;
+    // Unfinished searches are abandoned without running their callbacks
+    ~SearchScheduler() {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stopping = true;
+        }
+        tasksAvailable.notify_all();
+        for (std::thread & thread : threads) thread.join();
+        while (!runQueue.empty()) {
+            abandonGobangEngineSearch(runQueue.top()->engine);
+            delete runQueue.top();
+            runQueue.pop();
+        }
+    }
+    // Start searching the engine's current board; returns false, without calling done, for invalid limits
+    bool submit(GobangEngine * engine, const GobangSearchLimits & limits, int priority, Callback done) {
+        if (!beginGobangEngineSearch(engine, &limits)) return false;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            runQueue.push(new Task{ engine, std::max(1, priority), currentVirtualTime, nextSequence++, 0, std::move(done) });
+        }
+        tasksAvailable.notify_one();
+        return true;
+    }
+};
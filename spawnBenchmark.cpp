@@ -0,0 +1,55 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <unistd.h>
+#include "exec.h"
+
+/*
+    Spawn-to-first-byte latency of the fork and posix_spawn paths.
+
+    Usage: spawnBenchmark [iterations] [parentMiB] [pathname]
+    parentMiB of touched heap make the parent large, as a match harness holding many games is.
+    The child is expected to write at least one byte and exit, /bin/echo by default.
+*/
+
+double measureSpawnToFirstByte(const char * pathname, EngineSpawnMethod method) {
+    EngineSpawnOptions options = { method, 0, 0 };
+    EngineProcess process;
+    auto start = std::chrono::steady_clock::now();
+    if (!spawnEngineProcessWithOptions(pathname, &process, &options)) exit(1);
+    char byte;
+    if (read(process.stdoutFd, &byte, 1) != 1) {
+        fprintf(stderr, "%s wrote nothing\n", pathname);
+        exit(1);
+    }
+    auto end = std::chrono::steady_clock::now();
+    closeEngineProcess(&process, 0);
+    return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+void reportSpawnMethod(const char * name, const char * pathname, EngineSpawnMethod method, int iterations) {
+    std::vector<double> latencies;
+    for (int i = 0; i < iterations; i++)
+        latencies.push_back(measureSpawnToFirstByte(pathname, method));
+    std::sort(latencies.begin(), latencies.end());
+    printf("%-12s median %9.1fus  p90 %9.1fus  min %9.1fus\n", name,
+        latencies[latencies.size() / 2], latencies[latencies.size() * 9 / 10], latencies.front());
+}
+
+int main(int argc, char ** argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 200;
+    size_t parentMiB = argc > 2 ? atoi(argv[2]) : 0;
+    const char * pathname = argc > 3 ? argv[3] : "/bin/echo";
+    if (iterations <= 0) return 1;
+
+    std::vector<char> ballast(parentMiB << 20);
+    memset(ballast.data(), 1, ballast.size());
+
+    printf("%d spawns of %s, parent heap %zuMiB\n", iterations, pathname, parentMiB);
+    reportSpawnMethod("fork", pathname, ENGINE_SPAWN_FORK, iterations);
+    reportSpawnMethod("posix_spawn", pathname, ENGINE_SPAWN_POSIX_SPAWN, iterations);
+    return 0;
+}
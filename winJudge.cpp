@@ -0,0 +1,21 @@
+#include "winJudge.h"
+
+ChessPiece judgeWinsAt(const ChessboardGrid & grid, int x, int y) {
+    if (x < 0 || y < 0 || x >= SIZE || y >= SIZE) return EMPTY;
+    ChessPiece piece = grid.get(x, y);
+    if (piece != EMPTY && grid.isFiveAt(piece, x, y)) return piece;
+    return EMPTY;
+}
+
+ChessPiece judgeWinsOnBoard(const ChessboardGrid & grid) {
+    return grid.findFive();
+}
+
+const char * getWinPrompt(ChessPiece finishedChess) {
+    switch (finishedChess) {
+        case EMPTY: return NULL;
+        case PLAYER: return "Player wins!";
+        case BOT: return "Bot wins!";
+        default: return "Unknown error: wins";
+    }
+}
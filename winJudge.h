@@ -0,0 +1,12 @@
+#pragma once
+#include "gobang.h"
+#include "grid.hpp"
+
+// Five-in-a-row judge shared by the engine (gobang) and the game loop (main)
+
+// Check only the four lines through the last move (x, y), returns the winner or EMPTY
+ChessPiece judgeWinsAt(const ChessboardGrid & grid, int x, int y);
+// Stateless sweep over the whole board, returns the winner or EMPTY
+ChessPiece judgeWinsOnBoard(const ChessboardGrid & grid);
+// Human readable result for a winner returned by the functions above, NULL for EMPTY
+const char * getWinPrompt(ChessPiece finishedChess);